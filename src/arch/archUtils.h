@@ -1,10 +1,43 @@
 #ifndef ARCH_UTILS_H
 #define ARCH_UTILS_H
 
+#include <vector>
+#include <SDL.h>
+
 namespace ArchUtils
 {
   /// Returns the full path of the preferred config file to load.
   std::string findConfigFile( const std::string &name );
+
+  /// Returns the full path for a cache file, creating its directory.
+  std::string findCacheFile( const std::string &name );
+
+  /// Microseconds from an arbitrary start, never goes backwards.
+  Uint64 monotonicMicros();
+
+  /// Puts the calling thread to sleep for at least this long.
+  void sleepMicros( Uint32 micros );
+
+  /// Number of processors available for worker threads, at least 1.
+  int processorCount();
+
+  /// Starts watching a directory for entries coming, going or changing.
+  /// Returns -1 when the platform can't, callers then check for themselves.
+  int watchDirectory( const std::string &path );
+
+  /// Stops a watch from watchDirectory.
+  void unwatchDirectory( int watch );
+
+  /// Adds the watches that fired since the last call, never blocks.
+  void changedDirectories( std::vector<int> &watches );
+
+  /// what runSelf returns when it didn't get an exit code
+  enum { ProcessUnsupported = -1, ProcessCrashed = -2 };
+
+  /// Runs this same program again with args, collecting its stdout, and
+  /// waits for it. Returns its exit code, ProcessCrashed if it died on a
+  /// signal, or ProcessUnsupported when the platform can't.
+  int runSelf( const std::vector<std::string> &args, std::string &output );
 };
 
 #endif // ARCH_UTILS_H
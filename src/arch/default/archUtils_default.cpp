@@ -1,6 +1,8 @@
 
 #include <string>
 
+#include <SDL_thread.h>
+
 #include "archUtils.h"
 
 std::string ArchUtils::findConfigFile( const std::string &name )
@@ -8,3 +10,63 @@ std::string ArchUtils::findConfigFile( const std::string &name )
   return name;
 }
 
+std::string ArchUtils::findCacheFile( const std::string &name )
+{
+  return name;
+}
+
+// made during static init, before any thread can be started
+static SDL_mutex *monotonicLock = SDL_CreateMutex();
+
+Uint64 ArchUtils::monotonicMicros()
+{
+  // SDL_GetTicks wraps after 49 days, so carry the high bits ourselves.
+  // the batch runner's pool threads call in too, so the carry is locked.
+  static Uint32 lastTicks = 0;
+  static Uint64 wraps = 0;
+
+  SDL_mutexP( monotonicLock );
+  const Uint32 ticks = SDL_GetTicks();
+  if ( ticks < lastTicks ) {
+    wraps += (Uint64) 1 << 32;
+  }
+  lastTicks = ticks;
+  const Uint64 micros = ( wraps + ticks ) * 1000;
+  SDL_mutexV( monotonicLock );
+
+  return micros;
+}
+
+void ArchUtils::sleepMicros( Uint32 micros )
+{
+  // millisecond granularity is the best we get here, round down so
+  // schedulers don't oversleep past their deadline.
+  SDL_Delay( micros / 1000 );
+}
+
+int ArchUtils::processorCount()
+{
+  // no portable way to ask, play it safe.
+  return 1;
+}
+
+int ArchUtils::watchDirectory( const std::string &path )
+{
+  return -1;
+}
+
+void ArchUtils::unwatchDirectory( int watch )
+{
+  /* */
+}
+
+void ArchUtils::changedDirectories( std::vector<int> &watches )
+{
+  /* */
+}
+
+int ArchUtils::runSelf( const std::vector<std::string> &args, std::string &output )
+{
+  return ProcessUnsupported;
+}
+
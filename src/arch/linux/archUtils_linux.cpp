@@ -1,6 +1,14 @@
 
 #include <string>
 #include <cstdlib>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/inotify.h>
 
 #include "archUtils.h"
 
@@ -42,3 +50,148 @@ std::string ArchUtils::findConfigFile( const std::string &name )
   return name;
 }
 
+std::string ArchUtils::findCacheFile( const std::string &name )
+{
+  std::string location;
+  const char freezzt[] = "freezzt";
+
+  char *cache = getenv("XDG_CACHE_HOME");
+  if ( cache ) {
+    location = cache;
+  }
+  else {
+    cache = getenv("HOME");
+    if ( !cache ) return name;
+    location = cache;
+    location += "/.cache";
+    mkdir( location.c_str(), 0755 );
+  }
+
+  // already being there is fine, anything worse shows up on write
+  location += "/";
+  location += freezzt;
+  mkdir( location.c_str(), 0755 );
+
+  location += "/";
+  location += name;
+  return location;
+}
+
+Uint64 ArchUtils::monotonicMicros()
+{
+  timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (Uint64) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void ArchUtils::sleepMicros( Uint32 micros )
+{
+  timespec req;
+  req.tv_sec = micros / 1000000;
+  req.tv_nsec = ( micros % 1000000 ) * 1000;
+
+  // resume after signals with whatever time is left over
+  while ( nanosleep( &req, &req ) == -1 && errno == EINTR ) { /* */ }
+}
+
+int ArchUtils::processorCount()
+{
+  const long count = sysconf( _SC_NPROCESSORS_ONLN );
+  return ( count > 0 ) ? count : 1;
+}
+
+// one inotify descriptor for every watch, opened on first use
+static int inotifyFd()
+{
+  static int fd = -2;
+  if ( fd == -2 ) {
+    fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  }
+  return fd;
+}
+
+int ArchUtils::watchDirectory( const std::string &path )
+{
+  const int fd = inotifyFd();
+  if ( fd < 0 ) return -1;
+
+  const Uint32 mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                    | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+  return inotify_add_watch( fd, path.c_str(), mask );
+}
+
+void ArchUtils::unwatchDirectory( int watch )
+{
+  const int fd = inotifyFd();
+  if ( fd < 0 || watch < 0 ) return;
+  inotify_rm_watch( fd, watch );
+}
+
+void ArchUtils::changedDirectories( std::vector<int> &watches )
+{
+  const int fd = inotifyFd();
+  if ( fd < 0 ) return;
+
+  // events are packed back to back, each with its name tacked on the end
+  char buffer[4096] __attribute__(( aligned( __alignof__( inotify_event ) ) ));
+  ssize_t len;
+  while ( ( len = read( fd, buffer, sizeof(buffer) ) ) > 0 ) {
+    for ( char *p = buffer; p < buffer + len; ) {
+      const inotify_event *event = reinterpret_cast<inotify_event*>( p );
+      watches.push_back( event->wd );
+      p += sizeof(inotify_event) + event->len;
+    }
+  }
+}
+
+
+int ArchUtils::runSelf( const std::vector<std::string> &args, std::string &output )
+{
+  // everything the child needs is built before forking, other threads
+  // may hold locks that the child would never see released.
+  std::vector<char *> argv;
+  argv.push_back( const_cast<char *>( "freezzt" ) );
+  for ( unsigned int i = 0; i < args.size(); i++ ) {
+    argv.push_back( const_cast<char *>( args[i].c_str() ) );
+  }
+  argv.push_back( 0 );
+
+  // close on exec, so children started from other threads don't hold
+  // this pipe open and keep us from seeing the end of it
+  int fds[2];
+  if ( pipe2( fds, O_CLOEXEC ) != 0 ) return ProcessUnsupported;
+
+  const pid_t pid = fork();
+  if ( pid < 0 ) {
+    close( fds[0] );
+    close( fds[1] );
+    return ProcessUnsupported;
+  }
+
+  if ( pid == 0 ) {
+    dup2( fds[1], 1 );
+    execv( "/proc/self/exe", &argv[0] );
+    _exit( 127 );
+  }
+
+  close( fds[1] );
+  char buffer[4096];
+  for (;;) {
+    const ssize_t len = read( fds[0], buffer, sizeof(buffer) );
+    if ( len > 0 ) {
+      output.append( buffer, len );
+    }
+    else if ( len == 0 || errno != EINTR ) {
+      break;
+    }
+  }
+  close( fds[0] );
+
+  int status = 0;
+  while ( waitpid( pid, &status, 0 ) == -1 ) {
+    if ( errno != EINTR ) return ProcessUnsupported;
+  }
+
+  if ( WIFSIGNALED( status ) ) return ProcessCrashed;
+  return WIFEXITED( status ) ? WEXITSTATUS( status ) : ProcessCrashed;
+}
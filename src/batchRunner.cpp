@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <SDL.h>
+#include "archUtils.h"
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "worldLoader.h"
+#include "nullMusicStream.h"
+#include "headlessRunner.h"
+#include "taskPool.h"
+
+#include "batchRunner.h"
+
+// ---------------------------------------------------------------------------
+
+BatchResult::BatchResult()
+  : loaded( false ),
+    crashed( false ),
+    ticksRun( 0 ),
+    scriptErrors( 0 ),
+    ticksPerSecond( 0.0 )
+{
+  /* */
+}
+
+// ---------------------------------------------------------------------------
+
+// the one line a worker writes for the batch, among any logging
+static const char resultTag[] = "batch-result";
+
+/// loads and runs a world right here, in whatever process this is
+static void runWorld( BatchResult *result, int ticks )
+{
+  GameWorld *world = WorldLoader::loadWorld( result->filename );
+  if ( !world ) {
+    zerror() << "BatchTask: couldn't load" << result->filename;
+    return;
+  }
+  result->loaded = true;
+
+  NullMusicStream stream;
+  {
+    HeadlessRunner runner;
+    runner.setMusicStream( &stream );
+    runner.setWorld( world );
+
+    const Uint64 start = ArchUtils::monotonicMicros();
+    runner.exec( ticks );
+    const Uint64 elapsed = ArchUtils::monotonicMicros() - start;
+
+    result->ticksRun = runner.ticksRun();
+    result->ticksPerSecond = ( elapsed > 0 )
+                             ? result->ticksRun * 1000000.0 / elapsed
+                             : 0.0;
+  }
+
+  result->scriptErrors = world->scriptErrors();
+  world->setMusicStream( 0 );
+  delete world;
+}
+
+/// picks the worker's result line back out of everything it wrote
+static bool readWorkerResult( const std::string &output, BatchResult *result )
+{
+  std::string::size_type pos = output.find( resultTag );
+  while ( pos != std::string::npos && pos > 0 && output[pos - 1] != '\n' ) {
+    pos = output.find( resultTag, pos + 1 );
+  }
+  if ( pos == std::string::npos ) return false;
+
+  int loaded = 0;
+  const int fields = sscanf( output.c_str() + pos + sizeof(resultTag) - 1,
+                             " %d %d %d %lf", &loaded, &result->ticksRun,
+                             &result->scriptErrors, &result->ticksPerSecond );
+  result->loaded = ( loaded != 0 );
+  return fields == 4;
+}
+
+// ---------------------------------------------------------------------------
+
+class BatchTask : public AbstractTask
+{
+  public:
+    BatchTask( BatchResult *pResult, int pTicks )
+      : result( pResult ), ticks( pTicks ) { /* */ };
+
+    virtual void run();
+
+  private:
+    BatchResult *result;
+    int ticks;
+};
+
+void BatchTask::run()
+{
+  zinfo() << "BatchTask::run" << result->filename;
+
+  std::ostringstream ticksArg;
+  ticksArg << ticks;
+
+  std::vector<std::string> args;
+  args.push_back( "--batch-worker" );
+  args.push_back( "--ticks" );
+  args.push_back( ticksArg.str() );
+  args.push_back( result->filename );
+
+  std::string output;
+  const int status = ArchUtils::runSelf( args, output );
+
+  // 127 with nothing said means the worker never started
+  if ( status == ArchUtils::ProcessUnsupported ||
+       ( status == 127 && output.empty() ) ) {
+    runWorld( result, ticks );
+    return;
+  }
+
+  if ( status == ArchUtils::ProcessCrashed || !readWorkerResult( output, result ) ) {
+    zerror() << "BatchTask: worker crashed on" << result->filename;
+    result->crashed = true;
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+class BatchRunnerPrivate
+{
+  public:
+    BatchRunnerPrivate( BatchRunner *pSelf );
+
+  public:
+    int threadCount;
+    int ticks;
+    std::vector<BatchResult> results;
+
+  private:
+    BatchRunner *self;
+};
+
+BatchRunnerPrivate::BatchRunnerPrivate( BatchRunner *pSelf )
+  : threadCount( 0 ),
+    ticks( 1000 ),
+    self( pSelf )
+{
+  /* */
+}
+
+// ---------------------------------------------------------------------------
+
+BatchRunner::BatchRunner()
+  : d( new BatchRunnerPrivate(this) )
+{
+  /* */
+}
+
+BatchRunner::~BatchRunner()
+{
+  delete d;
+  d = 0;
+}
+
+void BatchRunner::setThreadCount( int threads )
+{
+  d->threadCount = threads;
+}
+
+void BatchRunner::setTicks( int ticks )
+{
+  d->ticks = ticks;
+}
+
+void BatchRunner::addWorld( const ZString &filename )
+{
+  BatchResult result;
+  result.filename = filename;
+  d->results.push_back( result );
+}
+
+void BatchRunner::exec()
+{
+  const int threads = ( d->threadCount > 0 )
+                      ? d->threadCount
+                      : ArchUtils::processorCount();
+
+  // the results vector doesn't grow from here on, tasks can point into it
+  std::vector<BatchTask> tasks;
+  tasks.reserve( d->results.size() );
+  for ( unsigned int i = 0; i < d->results.size(); i++ ) {
+    tasks.push_back( BatchTask( &d->results[i], d->ticks ) );
+  }
+
+  TaskPool pool( threads );
+  for ( unsigned int i = 0; i < tasks.size(); i++ ) {
+    pool.add( &tasks[i] );
+  }
+  pool.wait();
+}
+
+int BatchRunner::worldCount() const
+{
+  return d->results.size();
+}
+
+const BatchResult &BatchRunner::result( int index ) const
+{
+  assert( index >= 0 && index < worldCount() );
+  return d->results[index];
+}
+
+int BatchRunner::reportResults() const
+{
+  int failed = 0;
+  for ( unsigned int i = 0; i < d->results.size(); i++ ) {
+    const BatchResult &result = d->results[i];
+    if ( result.crashed ) {
+      zout() << result.filename << "\tCRASHED\n";
+      failed += 1;
+      continue;
+    }
+    if ( !result.loaded ) {
+      zout() << result.filename << "\tFAILED\n";
+      failed += 1;
+      continue;
+    }
+
+    zout() << result.filename << "\tOK"
+           << "\tticks " << result.ticksRun
+           << "\terrors " << result.scriptErrors
+           << "\tticks/sec " << (int)( result.ticksPerSecond + 0.5 ) << "\n";
+  }
+  return failed;
+}
+
+
+int BatchRunner::execWorker( const ZString &filename, int ticks )
+{
+  BatchResult result;
+  result.filename = filename;
+  runWorld( &result, ticks );
+
+  zout() << resultTag
+         << " " << ( result.loaded ? 1 : 0 )
+         << " " << result.ticksRun
+         << " " << result.scriptErrors
+         << " " << result.ticksPerSecond << "\n";
+  zout().flush();
+  return result.loaded ? 0 : 1;
+}
+
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "zstring.h"
+
+class BatchRunnerPrivate;
+
+/// How one world of a batch fared
+class BatchResult
+{
+  public:
+    BatchResult();
+
+    ZString filename;
+    bool loaded;
+    /// took its process down, only the other worlds got results
+    bool crashed;
+    int ticksRun;
+    int scriptErrors;
+    double ticksPerSecond;
+};
+
+/// Loads and runs many worlds headlessly, spread over a TaskPool. Every
+/// world runs in a worker process of its own where the platform allows,
+/// so one that crashes only loses its own result.
+class BatchRunner
+{
+  public:
+    BatchRunner();
+    virtual ~BatchRunner();
+
+    /// worker threads to use, 0 for one per processor
+    void setThreadCount( int threads );
+
+    /// game ticks to run each world for
+    void setTicks( int ticks );
+
+    /// queues a world file for the next exec
+    void addWorld( const ZString &filename );
+
+    /// runs every queued world, blocks until they're all done
+    void exec();
+
+    /// accessor
+    int worldCount() const;
+    /// accessor, valid after exec
+    const BatchResult &result( int index ) const;
+
+    /// writes one line per world to zout, returns how many failed to load
+    /// or crashed
+    int reportResults() const;
+
+    /// the worker process side, runs one world and writes its result
+    /// for the batch to pick up. returns the process exit code.
+    static int execWorker( const ZString &filename, int ticks );
+
+  private:
+    BatchRunnerPrivate *d;
+};
+
+#endif // BATCH_RUNNER_H
+
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -14,14 +15,23 @@
 #include <algorithm>
 #include <cassert>
 
+#include <SDL.h>
+#include <SDL_thread.h>
+
 #include "debug.h"
 #include "zstring.h"
+#include "archUtils.h"
+#include "taskPool.h"
+#include "worldIndex.h"
+#include "worldIndexCache.h"
 #include "fileListModel.h"
 
 struct FileTuple
 {
   ZString name;
   ZString data;
+  /// world title from the index, when this is a world
+  ZString title;
   bool isDirectory;
 
   FileTuple( const ZString &n, const ZString d, bool i )
@@ -31,7 +41,7 @@ struct FileTuple
   {
     if ( this->isDirectory && !other.isDirectory ) return true;
     if ( !this->isDirectory && other.isDirectory ) return false;
-    return ( (this->name.lower()) < (other.name.lower()) );
+    return ( this->name.compareNoCase( other.name ) < 0 );
   };
 };
 
@@ -48,6 +58,8 @@ class DirList
     const ZString & currentPath() const;
     bool currentIsDirectory() const;
     bool currentIsValid() const;
+    /// stats the current entry, which next() avoids where it can
+    bool statCurrent( long long &mtime, long long &size ) const;
 
   private:
     DIR *dir;
@@ -63,7 +75,7 @@ DirList::DirList( const ZString &dirpath )
   : dir(0), ent(0), path(dirpath), c_valid(false), c_dir(false)
 {
   dir = opendir( path.c_str() );
-  if ( !dir ) zwarn() << "Error listing" << dir;
+  if ( !dir ) zwarn() << "Error listing" << path;
 }
 
 DirList::~DirList()
@@ -76,36 +88,45 @@ bool DirList::next()
   if ( !dir ) return false;
 
   ent = readdir( dir );
-  if ( ent )
+  if ( !ent ) return false;
+
+  c_shortname = ZString(ent->d_name);
+  c_fullpath = path + "/" + c_shortname;
+  c_valid = false;
+  c_dir = false;
+
+  if ( c_shortname == "." ) return true;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+  // most filesystems say what the entry is, links and the rest need a stat
+  if ( ent->d_type == DT_DIR ) {
+    c_valid = true;
+    c_dir = true;
+    c_shortname += "/";
+    return true;
+  }
+  else if ( ent->d_type == DT_REG ) {
+    c_valid = true;
+    return true;
+  }
+  else if ( ent->d_type != DT_UNKNOWN && ent->d_type != DT_LNK ) {
+    return true;
+  }
+#endif
+
+  struct stat inode;
+  if ( stat(c_fullpath.c_str(), &inode) == 0 )
   {
-    struct stat inode;
-    c_shortname = ZString(ent->d_name);
-    c_fullpath = path + "/" + ZString(ent->d_name);
-    if ( stat(c_fullpath.c_str(), &inode) == 0 &&
-         c_shortname != "." )
-    {
-      if ( S_ISDIR(inode.st_mode) ) {
-        c_valid = true;
-        c_dir = true;
-        c_shortname += "/";
-      }
-      else if ( S_ISREG(inode.st_mode) ) {
-        c_valid = true;
-        c_dir = false;
-      }
-      else {
-        c_valid = false;
-        c_dir = false;
-      }
+    if ( S_ISDIR(inode.st_mode) ) {
+      c_valid = true;
+      c_dir = true;
+      c_shortname += "/";
     }
-    else {
-      c_valid = false;
-      c_dir = false;
+    else if ( S_ISREG(inode.st_mode) ) {
+      c_valid = true;
     }
-    return true;
   }
-
-  return false;
+  return true;
 }
 
 const ZString & DirList::currentName() const
@@ -128,43 +149,346 @@ bool DirList::currentIsValid() const
   return c_valid;
 }
 
+bool DirList::statCurrent( long long &mtime, long long &size ) const
+{
+  struct stat inode;
+  if ( stat(c_fullpath.c_str(), &inode) != 0 ) return false;
+  mtime = inode.st_mtime;
+  size = inode.st_size;
+  return true;
+}
+
+// -------------------------------------
+
+static bool isWorldName( const ZString &name )
+{
+  if ( name.length() < 4 ) return false;
+  const ZStringView ext = ZStringView( name ).sub( name.length() - 4, 4 );
+  return ( ext.equalsNoCase( ".zzt" ) || ext.equalsNoCase( ".sav" ) );
+}
+
+static long long directoryMTime( const ZString &dir )
+{
+  struct stat inode;
+  if ( stat(dir.c_str(), &inode) != 0 ) return -1;
+  return inode.st_mtime;
+}
+
+// -------------------------------------
+
+/// lists one directory on the scan thread
+class DirScanTask : public AbstractTask
+{
+  public:
+    DirScanTask()
+      : dirMTime( -1 ),
+        indexCache( 0 ),
+        watch( -1 ),
+        stale( false ),
+        lock( SDL_CreateMutex() ),
+        cancelled( false ),
+        done( false )
+    { /* */ };
+
+    ~DirScanTask()
+    {
+      SDL_DestroyMutex( lock );
+    };
+
+    virtual void run();
+
+    void cancel();
+    bool isCancelled();
+    bool isDone();
+
+  public:
+    ZString dir;
+    long long dirMTime;
+    std::vector<FileTuple> files;
+    WorldIndexCache *indexCache;
+
+    /// set up before the scan starts reading, so nothing that changes
+    /// during the scan gets missed. Only the main thread touches these.
+    int watch;
+    /// the watch fired while scanning, the listing may be out of date
+    bool stale;
+
+  private:
+    SDL_mutex *lock;
+    bool cancelled;
+    bool done;
+};
+
+void DirScanTask::run()
+{
+  dirMTime = directoryMTime( dir );
+  DirList dirlist(dir);
+
+  while ( !isCancelled() && dirlist.next() )
+  {
+    if ( !dirlist.currentIsValid() ) continue;
+
+    FileTuple tuple( dirlist.currentName(),
+                     dirlist.currentPath(),
+                     dirlist.currentIsDirectory() );
+
+    long long mtime, size;
+    if ( !tuple.isDirectory && isWorldName( tuple.name ) &&
+         dirlist.statCurrent( mtime, size ) )
+    {
+      const WorldIndex *index = indexCache->lookup( tuple.data, mtime, size );
+      if ( index ) tuple.title = index->title.str();
+    }
+
+    files.push_back( tuple );
+  }
+
+  sort( files.begin(), files.end() );
+  indexCache->save();
+
+  SDL_LockMutex( lock );
+  done = true;
+  SDL_UnlockMutex( lock );
+}
+
+void DirScanTask::cancel()
+{
+  SDL_LockMutex( lock );
+  cancelled = true;
+  SDL_UnlockMutex( lock );
+}
+
+bool DirScanTask::isCancelled()
+{
+  SDL_LockMutex( lock );
+  const bool c = cancelled;
+  SDL_UnlockMutex( lock );
+  return c;
+}
+
+bool DirScanTask::isDone()
+{
+  SDL_LockMutex( lock );
+  const bool d = done;
+  SDL_UnlockMutex( lock );
+  return d;
+}
+
+// -------------------------------------
+
+/// a listing kept around after leaving its directory
+struct DirCacheEntry
+{
+  std::vector<FileTuple> files;
+  /// from ArchUtils::watchDirectory, -1 falls back to the directory mtime
+  int watch;
+  long long dirMTime;
+  /// when the directory was last shown, the smallest goes first
+  unsigned int lastUsed;
+};
+
+typedef std::map<ZString, DirCacheEntry> DirCacheMap;
+
 // -------------------------------------
 
 class FileListModelPrivate
 {
   public:
     FileListModelPrivate( FileListModel *pSelf );
-    void makeDirList( const ZString &dir );
+    ~FileListModelPrivate();
+
+    void showDirectory( const ZString &dir );
+    void startScan( const ZString &dir );
+    void dropScan();
+    bool finishScan();
+    bool isCached( const ZString &dir );
+    void dropCached( DirCacheMap::iterator it );
+    void dropOldest();
+    void checkWatches();
     static ZString cwd();
 
   public:
     std::vector<FileTuple> fileList;
+    ZString currentDir;
+    DirCacheMap dirCache;
+    unsigned int useCount;
+
+    /// only the scan thread touches this once it's loaded
+    WorldIndexCache indexCache;
+    TaskPool scanPool;
+    DirScanTask *scanTask;
 
   private:
     FileListModel *self;
 };
 
+// enough for wandering up and down a tree without holding every watch
+static const unsigned int maxCachedDirs = 32;
+
 FileListModelPrivate::FileListModelPrivate( FileListModel *pSelf )
-  : self( pSelf )
+  : useCount( 0 ),
+    scanPool( 1 ),
+    scanTask( 0 ),
+    self( pSelf )
 {
-  /* */
+  indexCache.load( ArchUtils::findCacheFile("worldindex") );
 }
 
-void FileListModelPrivate::makeDirList( const ZString &dir )
+FileListModelPrivate::~FileListModelPrivate()
 {
+  dropScan();
+
+  for ( DirCacheMap::iterator it = dirCache.begin(); it != dirCache.end(); ++it ) {
+    ArchUtils::unwatchDirectory( it->second.watch );
+  }
+}
+
+void FileListModelPrivate::showDirectory( const ZString &dir )
+{
+  currentDir = dir;
+  checkWatches();
+
+  if ( isCached( dir ) ) {
+    DirCacheEntry &entry = dirCache[dir];
+    entry.lastUsed = ++useCount;
+    fileList = entry.files;
+    return;
+  }
+
   fileList.clear();
-  DirList dirlist(dir);
+  startScan( dir );
+}
 
-  while ( dirlist.next() )
-  {
-    if ( !dirlist.currentIsValid() ) continue;
+void FileListModelPrivate::startScan( const ZString &dir )
+{
+  if ( scanTask ) {
+    if ( scanTask->dir == dir ) return;
 
-    fileList.push_back( FileTuple( dirlist.currentName(),
-                                   dirlist.currentPath(),
-                                   dirlist.currentIsDirectory() ) );
+    // nobody wants the old one anymore
+    dropScan();
   }
 
-  sort( fileList.begin(), fileList.end() );
+  scanTask = new DirScanTask;
+  scanTask->dir = dir;
+  scanTask->indexCache = &indexCache;
+  scanTask->watch = ArchUtils::watchDirectory( dir );
+  scanPool.add( scanTask );
+}
+
+void FileListModelPrivate::dropScan()
+{
+  if ( !scanTask ) return;
+  scanTask->cancel();
+  scanPool.wait();
+  ArchUtils::unwatchDirectory( scanTask->watch );
+  delete scanTask;
+  scanTask = 0;
+}
+
+bool FileListModelPrivate::finishScan()
+{
+  if ( !scanTask || !scanTask->isDone() ) return false;
+  scanPool.wait();
+
+  const ZString dir = scanTask->dir;
+  const bool shown = ( dir == currentDir );
+
+  if ( scanTask->stale ) {
+    // something changed under the scan, show what we have but don't
+    // keep it, and have another look with a fresh watch
+    if ( shown ) {
+      fileList.swap( scanTask->files );
+    }
+    dropScan();
+    if ( shown ) startScan( dir );
+    return shown;
+  }
+
+  DirCacheMap::iterator it = dirCache.find( dir );
+  if ( it == dirCache.end() ) {
+    if ( dirCache.size() >= maxCachedDirs ) {
+      dropOldest();
+    }
+    DirCacheEntry fresh;
+    fresh.watch = scanTask->watch;
+    it = dirCache.insert( std::make_pair( dir, fresh ) ).first;
+  }
+  else {
+    // already watched through the entry
+    ArchUtils::unwatchDirectory( scanTask->watch );
+  }
+  scanTask->watch = -1;
+
+  it->second.files.swap( scanTask->files );
+  it->second.dirMTime = scanTask->dirMTime;
+  it->second.lastUsed = ++useCount;
+
+  if ( shown ) {
+    fileList = it->second.files;
+  }
+
+  delete scanTask;
+  scanTask = 0;
+  return shown;
+}
+
+bool FileListModelPrivate::isCached( const ZString &dir )
+{
+  DirCacheMap::iterator it = dirCache.find( dir );
+  if ( it == dirCache.end() ) return false;
+
+  // without a watch, entries coming or going still bump the mtime
+  if ( it->second.watch < 0 && it->second.dirMTime != directoryMTime( dir ) ) {
+    dropCached( it );
+    return false;
+  }
+  return true;
+}
+
+void FileListModelPrivate::dropCached( DirCacheMap::iterator it )
+{
+  ArchUtils::unwatchDirectory( it->second.watch );
+  dirCache.erase( it );
+}
+
+void FileListModelPrivate::dropOldest()
+{
+  DirCacheMap::iterator oldest = dirCache.begin();
+  for ( DirCacheMap::iterator it = dirCache.begin(); it != dirCache.end(); ++it ) {
+    if ( it->second.lastUsed < oldest->second.lastUsed ) {
+      oldest = it;
+    }
+  }
+  if ( oldest != dirCache.end() ) {
+    dropCached( oldest );
+  }
+}
+
+void FileListModelPrivate::checkWatches()
+{
+  std::vector<int> changed;
+  ArchUtils::changedDirectories( changed );
+  if ( changed.empty() ) return;
+
+  if ( scanTask && scanTask->watch >= 0 &&
+       std::find( changed.begin(), changed.end(), scanTask->watch ) != changed.end() )
+  {
+    zdebug() << "FileListModel: changed while scanning" << scanTask->dir;
+    scanTask->stale = true;
+  }
+
+  for ( DirCacheMap::iterator it = dirCache.begin(); it != dirCache.end(); ) {
+    DirCacheMap::iterator cur = it++;
+    if ( cur->second.watch >= 0 &&
+         std::find( changed.begin(), changed.end(), cur->second.watch ) != changed.end() )
+    {
+      zdebug() << "FileListModel: changed" << cur->first;
+      const bool shown = ( cur->first == currentDir );
+      dropCached( cur );
+      // the old listing stays up until the new one is ready
+      if ( shown ) startScan( currentDir );
+    }
+  }
 }
 
 ZString FileListModelPrivate::cwd()
@@ -183,7 +507,7 @@ ZString FileListModelPrivate::cwd()
 FileListModel::FileListModel()
   : d( new FileListModelPrivate(this) )
 {
-  d->makeDirList( d->cwd() ); 
+  d->showDirectory( d->cwd() ); 
 }
 
 FileListModel::~FileListModel()
@@ -194,6 +518,9 @@ FileListModel::~FileListModel()
 
 ZString FileListModel::getTitleMessage() const
 {
+  if ( d->fileList.empty() && d->scanTask ) {
+    return ZString("Scanning...");
+  }
   return ZString("Load World");
 }
 
@@ -203,7 +530,18 @@ ZString FileListModel::getLineMessage( int line ) const
     return ZString();
   }
 
-  return d->fileList.at(line).name;
+  const FileTuple &tuple = d->fileList.at(line);
+  if ( tuple.title.empty() ) return tuple.name;
+
+  // dos names fit in 12, titles line up after them
+  ZString message = tuple.name;
+  if ( message.length() < 13 ) {
+    message.append( 13 - message.length(), ' ' );
+  }
+  else {
+    message += " ";
+  }
+  return message + tuple.title;
 }
 
 ZString FileListModel::getLineData( int line ) const
@@ -246,5 +584,11 @@ void FileListModel::setDirectory( const ZString &dir )
 {
   if ( dir.empty() ) return;
 
-  d->makeDirList( dir );
+  d->showDirectory( dir );
+}
+
+bool FileListModel::update()
+{
+  d->checkWatches();
+  return d->finishScan();
 }
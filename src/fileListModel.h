@@ -24,7 +24,9 @@ class FileListModel : public AbstractScrollModel
     virtual bool isHighlighted( int line ) const;
     virtual Action getAction( int line ) const;
     virtual int lineCount() const;
+    virtual bool update();
 
+    /// shows a cached listing right away, otherwise scans in the background
     void setDirectory( const ZString &dir );
 
   private:
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <string>
+#include <SDL.h>
+
+#include "archUtils.h"
+#include "debug.h"
+#include "frameScheduler.h"
+
+// ---------------------------------------------------------------------------
+
+class FrameSchedulerPrivate
+{
+  public:
+    FrameSchedulerPrivate();
+
+  public:
+    Uint32 tickMicros;
+    int maxCatchUp;
+
+    Uint64 lastClock;
+    Uint64 accumulator;
+
+    Uint64 ticksRun;
+    Uint64 lateTicks;
+    Uint64 droppedTicks;
+};
+
+FrameSchedulerPrivate::FrameSchedulerPrivate()
+  : tickMicros( 27000 ),
+    maxCatchUp( 5 ),
+    lastClock( 0 ),
+    accumulator( 0 ),
+    ticksRun( 0 ),
+    lateTicks( 0 ),
+    droppedTicks( 0 )
+{
+  /* */
+}
+
+// ---------------------------------------------------------------------------
+
+FrameScheduler::FrameScheduler()
+  : d( new FrameSchedulerPrivate )
+{
+  /* */
+}
+
+FrameScheduler::~FrameScheduler()
+{
+  delete d;
+  d = 0;
+}
+
+void FrameScheduler::setTickMicros( Uint32 micros )
+{
+  d->tickMicros = ( micros > 0 ) ? micros : 1;
+}
+
+Uint32 FrameScheduler::tickMicros() const
+{
+  return d->tickMicros;
+}
+
+void FrameScheduler::setMaxCatchUp( int ticks )
+{
+  d->maxCatchUp = ( ticks > 0 ) ? ticks : 1;
+}
+
+void FrameScheduler::start()
+{
+  d->lastClock = ArchUtils::monotonicMicros();
+  d->accumulator = 0;
+}
+
+int FrameScheduler::ticksDue()
+{
+  const Uint64 clock = ArchUtils::monotonicMicros();
+  d->accumulator += clock - d->lastClock;
+  d->lastClock = clock;
+
+  Uint64 due = d->accumulator / d->tickMicros;
+  if ( due == 0 ) return 0;
+
+  if ( due > (Uint64) d->maxCatchUp ) {
+    // too far behind to catch up without a visible fast-forward
+    d->droppedTicks += due - d->maxCatchUp;
+    d->accumulator %= d->tickMicros;
+    due = d->maxCatchUp;
+  }
+  else {
+    d->accumulator -= due * d->tickMicros;
+  }
+
+  // only the newest tick was on time
+  d->lateTicks += due - 1;
+  d->ticksRun += due;
+  return (int) due;
+}
+
+void FrameScheduler::waitForNextTick( Uint32 maxMicros )
+{
+  const Uint64 clock = ArchUtils::monotonicMicros();
+  const Uint64 pending = d->accumulator + ( clock - d->lastClock );
+  if ( pending >= d->tickMicros ) return;
+
+  Uint32 wait = d->tickMicros - (Uint32) pending;
+  if ( wait > maxMicros ) wait = maxMicros;
+  ArchUtils::sleepMicros( wait );
+}
+
+Uint64 FrameScheduler::ticksRun() const
+{
+  return d->ticksRun;
+}
+
+Uint64 FrameScheduler::lateTicks() const
+{
+  return d->lateTicks;
+}
+
+Uint64 FrameScheduler::droppedTicks() const
+{
+  return d->droppedTicks;
+}
+
+void FrameScheduler::logStats() const
+{
+  zinfo() << "FrameScheduler:" << d->ticksRun << "ticks,"
+          << d->lateTicks << "late,"
+          << d->droppedTicks << "dropped";
+}
+
@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <SDL.h>
+
+class FrameSchedulerPrivate;
+
+/// Fixed timestep clock, hands out update ticks as real time passes
+class FrameScheduler
+{
+  public:
+    FrameScheduler();
+    virtual ~FrameScheduler();
+
+    /// length of one update tick
+    void setTickMicros( Uint32 micros );
+    /// accessor
+    Uint32 tickMicros() const;
+
+    /// most ticks handed out at once before the backlog is dropped
+    void setMaxCatchUp( int ticks );
+
+    /// resets the clock, call before the first ticksDue
+    void start();
+
+    /// number of update ticks to run now, may be zero
+    int ticksDue();
+
+    /// sleeps until the next tick is due, or less if asked
+    void waitForNextTick( Uint32 maxMicros = 0xFFFFFFFF );
+
+    /// total ticks handed out
+    Uint64 ticksRun() const;
+    /// ticks that ran behind their deadline, but were caught up
+    Uint64 lateTicks() const;
+    /// ticks thrown away because we fell too far behind
+    Uint64 droppedTicks() const;
+
+    /// writes the stats to the log
+    void logStats() const;
+
+  private:
+    FrameSchedulerPrivate *d;
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cassert>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "randomizer.h"
+#include "replay.h"
+#include "abstractMusicStream.h"
+#include "abstractScrollModel.h"
+#include "scrollView.h"
+
+#include "headlessRunner.h"
+
+// ---------------------------------------------------------------------------
+
+class HeadlessRunnerPrivate
+{
+  public:
+    HeadlessRunnerPrivate();
+
+    void dismissScroll();
+
+  public:
+    GameWorld *world;
+    AbstractMusicStream *musicStream;
+    ScrollView scrollView;
+    int ticksRun;
+};
+
+HeadlessRunnerPrivate::HeadlessRunnerPrivate()
+  : world(0),
+    musicStream(0),
+    ticksRun(0)
+{
+  /* */
+}
+
+void HeadlessRunnerPrivate::dismissScroll()
+{
+  // nobody is around to read it, so close it the way the text view would
+  if ( !scrollView.model() ) return;
+  delete scrollView.model();
+  scrollView.setModel(0);
+}
+
+// ---------------------------------------------------------------------------
+
+HeadlessRunner::HeadlessRunner()
+  : d( new HeadlessRunnerPrivate )
+{
+  /* */
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+  d->dismissScroll();
+  if ( d->world ) {
+    d->world->setScrollView( 0 );
+  }
+  delete d;
+  d = 0;
+}
+
+void HeadlessRunner::setWorld( GameWorld *world )
+{
+  d->world = world;
+  if ( !world ) return;
+
+  world->setScrollView( &d->scrollView );
+  world->setCurrentBoard( world->getBoard( world->startBoard() ) );
+  if ( d->musicStream ) {
+    world->setMusicStream( d->musicStream );
+  }
+}
+
+void HeadlessRunner::setMusicStream( AbstractMusicStream *stream )
+{
+  d->musicStream = stream;
+  if ( d->world ) {
+    d->world->setMusicStream( stream );
+  }
+}
+
+void HeadlessRunner::exec( int ticks )
+{
+  assert( d->world );
+  assert( d->musicStream );
+
+  zinfo() << "HeadlessRunner::exec" << ticks << "ticks";
+
+  for ( int i = 0; i < ticks; i++ ) {
+    d->world->exec();
+    d->dismissScroll();
+    d->ticksRun += 1;
+  }
+}
+
+bool HeadlessRunner::replay( const ReplayFile &replay )
+{
+  assert( d->world );
+  assert( d->musicStream );
+
+  if ( !d->world->restoreSnapshot( replay.start ) ) {
+    zerror() << "HeadlessRunner::replay: bad starting snapshot";
+    return false;
+  }
+  d->world->randomizer().seed( replay.seed );
+
+  zinfo() << "HeadlessRunner::replay" << replay.ticks.size() << "ticks";
+
+  for ( unsigned int i = 0; i < replay.ticks.size(); i++ ) {
+    const ReplayTick &tick = replay.ticks[i];
+
+    // the live game switches boards during the transition, between cycles
+    if ( d->world->isChangingBoard() ) {
+      d->world->setCurrentBoard( d->world->getBoard( d->world->changingIndex() ) );
+    }
+
+    for ( unsigned int k = 0; k < tick.keys.size(); k++ ) {
+      d->world->addInputKey( tick.keys[k].keycode, tick.keys[k].unicode );
+    }
+    d->world->exec();
+    d->dismissScroll();
+    d->ticksRun += 1;
+
+    const unsigned int hash = ReplayFile::hashWorld( d->world );
+    if ( hash != tick.hash ) {
+      zerror() << "HeadlessRunner::replay: diverged at tick" << i;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int HeadlessRunner::ticksRun() const
+{
+  return d->ticksRun;
+}
+
@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __HEADLESS_RUNNER_H__
+#define __HEADLESS_RUNNER_H__
+
+class GameWorld;
+class AbstractMusicStream;
+class ReplayFile;
+class HeadlessRunnerPrivate;
+
+/// Runs a world as fast as possible, with no display or input
+class HeadlessRunner
+{
+  public:
+    HeadlessRunner();
+    virtual ~HeadlessRunner();
+
+    /// world to run, starts on its start board
+    void setWorld( GameWorld *world );
+
+    /// stream that receives the world's music
+    void setMusicStream( AbstractMusicStream *stream );
+
+    /// runs the world for a number of game ticks
+    void exec( int ticks );
+
+    /// restores the replay's starting state into the world, feeds it the
+    /// recorded input and checks every tick's hash. false on the first
+    /// tick that doesn't match.
+    bool replay( const ReplayFile &replay );
+
+    /// ticks executed so far
+    int ticksRun() const;
+
+  private:
+    HeadlessRunnerPrivate *d;
+};
+
+#endif /* __HEADLESS_RUNNER_H__ */
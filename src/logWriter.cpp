@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cassert>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include "debug.h"
+#include "logWriter.h"
+
+// how long the thread naps once the ring is empty
+static const int idleMillis = 5;
+
+// ---------------------------------------------------------------------------
+
+class LogWriterPrivate
+{
+  public:
+    LogWriterPrivate();
+    ~LogWriterPrivate();
+
+    bool isQuitting();
+
+    static int writerMain( void *data );
+
+  public:
+    SDL_Thread *thread;
+
+    // guards quitting
+    SDL_mutex *lock;
+    bool quitting;
+};
+
+LogWriterPrivate::LogWriterPrivate()
+  : thread( 0 ),
+    lock( SDL_CreateMutex() ),
+    quitting( false )
+{
+  /* */
+}
+
+LogWriterPrivate::~LogWriterPrivate()
+{
+  SDL_DestroyMutex( lock );
+}
+
+bool LogWriterPrivate::isQuitting()
+{
+  SDL_LockMutex( lock );
+  const bool ret = quitting;
+  SDL_UnlockMutex( lock );
+  return ret;
+}
+
+int LogWriterPrivate::writerMain( void *data )
+{
+  LogWriterPrivate *self = static_cast<LogWriterPrivate*>( data );
+  while ( !self->isQuitting() ) {
+    if ( DebuggingStream::flushBuffered() == 0 ) {
+      SDL_Delay( idleMillis );
+    }
+  }
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+LogWriter::LogWriter()
+  : d( new LogWriterPrivate )
+{
+  /* */
+}
+
+LogWriter::~LogWriter()
+{
+  if ( d->thread ) {
+    stop();
+  }
+  delete d;
+  d = 0;
+}
+
+void LogWriter::start()
+{
+  assert( !d->thread );
+  d->quitting = false;
+  DebuggingStream::setBuffered( true );
+  DebuggingStream::setDropping( true );
+  d->thread = SDL_CreateThread( LogWriterPrivate::writerMain, d );
+}
+
+void LogWriter::stop()
+{
+  assert( d->thread );
+  SDL_LockMutex( d->lock );
+  d->quitting = true;
+  SDL_UnlockMutex( d->lock );
+  SDL_WaitThread( d->thread, 0 );
+  d->thread = 0;
+
+  DebuggingStream::setDropping( false );
+  DebuggingStream::setBuffered( false );
+
+  const unsigned int dropped = DebuggingStream::droppedLines();
+  if ( dropped > 0 ) {
+    zwarn() << "LogWriter: the log ring was full," << dropped << "lines dropped";
+  }
+}
@@ -0,0 +1,32 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+class LogWriterPrivate;
+
+/// Background thread that drains DebuggingStream's ring to stdout, so
+/// the threads doing the logging never wait on the terminal.
+class LogWriter
+{
+  public:
+    LogWriter();
+    virtual ~LogWriter();
+
+    /// switches logging over to the ring and starts the thread
+    void start();
+
+    /// writes out what's left, stops the thread and goes back to
+    /// writing lines directly. Reports any dropped lines.
+    void stop();
+
+  private:
+    LogWriterPrivate *d;
+};
+
+#endif // LOG_WRITER_H
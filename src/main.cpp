@@ -47,20 +47,28 @@
 
 #include "debug.h"
 #include "zstring.h"
+#include "logWriter.h"
 #include "sdlManager.h"
 
 int main( int argc, char ** argv )
 {
   DebuggingStream::setGlobalLevel( DebuggingStream::INFORMATIVE );
+
+  // loading a big world logs every board and thing, keep that off the
+  // main thread
+  LogWriter logWriter;
+  logWriter.start();
   zinfo() << "Starting";
 
   SDLManager sdlManager( argc, argv );
 
+  int status = 0;
   if (sdlManager.valid()) {
-    sdlManager.exec();
+    status = sdlManager.exec();
   }
 
   zinfo() << "Done.";
-  return 0;
+  logWriter.stop();
+  return status;
 }
 
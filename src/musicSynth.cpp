@@ -0,0 +1,222 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cmath>
+#include <list>
+
+#include <SDL.h>
+
+#include "musicSynth.h"
+
+const float PI = 3.141592653589793;
+
+// ---------------------------------------------------------------------------
+
+template<typename T>
+class TemplateBufferFiller : public AbstractBufferFiller
+{
+  public:
+    virtual Uint32 fillBuffer( Sint8 *stream, int bytes, int volume,
+                               Uint32 phase, Uint32 increment )
+    {
+      for ( int i = 0; i < bytes; i++ ) {
+        stream[i] = mix( stream[i], wave.getSample( phase ), volume );
+        phase += increment;
+      }
+      return phase;
+    }
+
+  protected:
+    T wave;
+};
+
+// ---------------------------------------------------------------------------
+
+class SilentWaveform
+{
+  public:
+    static int getSample( Uint32 val ) { return 0; };
+};
+
+// -------------------------------------
+
+class SquareWaveform
+{
+  public: 
+    static int getSample( Uint32 val )
+    {
+      return 64 - ( (val & 0x80000000) >> 25 );
+    };
+};
+
+// -------------------------------------
+
+class TriangleWaveform
+{
+  public: 
+    static int getSample( Uint32 val )
+    {
+      const int gradient = (val >> 24) & 127;
+      return (val&0x80000000) ? (-64+gradient) : (64-gradient);
+    };
+};
+
+// -------------------------------------
+
+class SawtoothWaveform
+{
+  public: 
+    static int getSample( Uint32 val )
+    {
+      const int gradient = (val >> 25) & 127;
+      return 64 - gradient;
+    };
+};
+
+// -------------------------------------
+
+// my own little creation, combines a triangle and a square to sound more tinny.
+class TriSquareWaveform
+{
+  public: 
+    static int getSample( Uint32 val )
+    {
+      switch ( val >> 28 ) {
+        case 15: case 0:
+          return  64 - ((val >> 21) & 127);
+        case 1: case 2: case 3: case 4: case 5: case 6:
+          return  64;
+        case 7: case 8:
+          return -64 + ((val >> 21) & 127);
+        case 9: case 10: case 11: case 12: case 13: case 14: default:
+          return -64;
+      }
+    };
+};
+
+// -------------------------------------
+
+// each filler keeps its own table, so streams on other threads never
+// share a half built one.
+class SineWaveform
+{
+  public: 
+    SineWaveform()
+    {
+      for ( int i = 0; i < 1024; i++ ) {
+        m_wave_buffer[i] = (int) ( 64.0 * sin( 2.0*PI * (float)i / 1024.0 ) );
+      }
+    };
+
+    int getSample( Uint32 val ) const
+    {
+      // the 21st bit here can be considered a 0.5 that we're rounding up from.
+      const int index = ( val >> 22 ) + ( (val >> 21) & 1 );
+      return m_wave_buffer[ index & 1023 ];
+    };
+
+  private:
+    signed char m_wave_buffer[1024];
+};
+
+// ---------------------------------------------------------------------------
+
+AbstractBufferFiller *AbstractBufferFiller::create( int waveformType )
+{
+  // values follow the WaveformType enum shared by the music streams
+  switch ( waveformType ) {
+    case 1: return new TemplateBufferFiller<SineWaveform>;
+    case 2: return new TemplateBufferFiller<SquareWaveform>;
+    case 3: return new TemplateBufferFiller<TriangleWaveform>;
+    case 4: return new TemplateBufferFiller<SawtoothWaveform>;
+    case 5: return new TemplateBufferFiller<TriSquareWaveform>;
+    case 0:
+    default: break;
+  }
+  return new TemplateBufferFiller<SilentWaveform>;
+}
+
+// ---------------------------------------------------------------------------
+
+static const int MAX_NOTES = 90;
+
+// filled in before main, every stream only reads it afterwards
+class NoteTable
+{
+  public:
+    NoteTable()
+    {
+      // We have to reproduce the pretty bad inaccuracy of the PC speaker here
+      // The notes will all be slightly off to account for integer division.
+      const float PIT_TIMER = 1193180.0;
+      const float twelvth_root_of_two = pow(2.0, 1.0/12.0);
+
+      for ( int i = 0; i < MAX_NOTES; i++ ) {
+        float freq = 440.0 * pow( twelvth_root_of_two, i-49 );
+        notes[i] = floor( PIT_TIMER / floor( PIT_TIMER / round( freq ) ) );
+      }
+    };
+
+    float notes[MAX_NOTES];
+};
+
+static const NoteTable note_table;
+
+float Note::keyFrequency( int key )
+{
+  const int safe_key = ( key >= 0 && key < MAX_NOTES ) ? key : 0;
+  return note_table.notes[safe_key];
+}
+
+// ---------------------------------------------------------------------------
+
+void AudioThread::audio_callback(void *userdata, Uint8 *stream, int len)
+{
+  AudioThread *p = static_cast<AudioThread *>(userdata);
+  Sint8 *signed_stream = (Sint8 *) stream;
+  p->playback(signed_stream, len);
+}
+
+void AudioThread::playback(Sint8 *stream, int len)
+{
+  int fill = len;
+  int offset = 0;
+  while ( fill > 0 )
+  {
+    if ( currentNote.bytesLeft <= 0 )
+    {
+      if ( noteRoll.empty() ) break;
+      Uint32 oldPhase = currentNote.phase;
+      currentNote = noteRoll.front();
+      noteRoll.pop_front();
+      if ( currentNote.isNote ) {
+        currentNote.phase = oldPhase;
+      }
+    }
+
+    const int bytes = ( currentNote.bytesLeft < fill )
+                      ? currentNote.bytesLeft
+                      : fill;
+
+    if ( bytes <= 0 ) break;
+
+    if ( currentNote.isNote )
+    {
+      Uint32 increment = (Uint32) ( currentNote.hertz / ((float)hertz) * 4294967296.0 );
+      currentNote.phase = bufferFiller->fillBuffer( stream+offset, bytes, volume,
+                                                    currentNote.phase, increment );
+    }
+    else {
+      // TODO: Effects
+    }
+
+    fill -= bytes;
+    offset += bytes;
+    currentNote.bytesLeft -= bytes;
+  }
+}
+
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __MUSIC_SYNTH_H__
+#define __MUSIC_SYNTH_H__
+
+#include <list>
+#include <SDL.h>
+
+// Shared synthesis path for the music streams. Everything in here works
+// on plain sample buffers, so it's safe to drive without an audio device.
+
+// ---------------------------------------------------------------------------
+
+class AbstractBufferFiller
+{
+  public:
+    virtual ~AbstractBufferFiller() { /* */ };
+
+    virtual Uint32 fillBuffer( Sint8 *stream, int bytes, int volume,
+                               Uint32 phase, Uint32 increment ) = 0;
+
+    static inline Sint8 mix( int stream, int sample, int volume )
+    {
+      // crude mixer
+      const int mix_val = stream + ( ( sample * volume ) >> 7 );
+      if ( mix_val < -127 ) return -127;
+      if ( mix_val >  127 ) return  127;
+      return mix_val;
+    }
+
+    /// creates a filler for one of the streams' WaveformType values
+    static AbstractBufferFiller *create( int waveformType );
+};
+
+// ---------------------------------------------------------------------------
+
+struct Note
+{
+  bool isNote;
+  float hertz;
+  int effect;
+  int bytesLeft;
+  Uint32 phase;
+
+  Note( bool n = false, float h = 0.0, int e = -1, int b = 0 )
+    : isNote(n), hertz(h), effect(e), bytesLeft(b), phase(0)
+  { /* */ };
+
+  static Note createNote( float hertz, int bytes ) {
+    return Note( true, hertz, -1, bytes );
+  }
+
+  static Note createEffect( int effect, int bytes ) {
+    return Note( false, 0, effect, bytes );
+  }
+
+  /// PC speaker frequency of a zzt key, 40 is Middle C
+  static float keyFrequency( int key );
+};
+
+typedef std::list<Note> NoteList;
+
+// ---------------------------------------------------------------------------
+
+struct AudioThread
+{
+  int hertz;
+  int bufferLen;
+  int volume;
+  AbstractBufferFiller *bufferFiller;
+  NoteList noteRoll;
+  Note currentNote;
+
+  AudioThread( int hz = 44100, int len = 1024, int vol = 64,
+               AbstractBufferFiller *filler = 0 )
+    : hertz(hz), bufferLen(len), volume(vol), bufferFiller(filler)
+  {/**/};
+
+  void playback(Sint8 *stream, int len);
+  static void audio_callback(void *userdata, Uint8 *stream, int len);
+};
+
+#endif /* __MUSIC_SYNTH_H__ */
@@ -12,6 +12,7 @@
 #include "debug.h"
 #include "zstring.h"
 #include "abstractPainter.h"
+#include "frameStats.h"
 #include "simplePainter.h"
 #include "openglPainter.h"
 
@@ -117,8 +118,6 @@ void OpenGLPainterPrivate::render()
     glVertex3f( 0.f, polyHeight, 0.0f );
   glEnd();
   checkGLError();
-
-  SDL_GL_SwapBuffers();
 }
 
 // -----------------------------------------------------------------
@@ -154,6 +153,9 @@ void OpenGLPainter::end_impl()
 {
   d->simplePainter.end();
   d->render();
+
+  PhaseTimer timer( frameStats(), FrameStats::FlipPhase );
+  SDL_GL_SwapBuffers();
 }
 
 SDL_Surface * OpenGLPainter::createWindow( int w, int h, bool fullscreen )
@@ -163,6 +165,7 @@ SDL_Surface * OpenGLPainter::createWindow( int w, int h, bool fullscreen )
     surfaceFlags |= SDL_FULLSCREEN;
   }
 
+  SDL_GL_SetAttribute( SDL_GL_SWAP_CONTROL, vsync() ? 1 : 0 );
   SDL_Surface *display = SDL_SetVideoMode( w, h, 0, surfaceFlags );
 
   if (!display) {
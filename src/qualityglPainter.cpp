@@ -12,6 +12,7 @@
 #include "debug.h"
 #include "zstring.h"
 #include "abstractPainter.h"
+#include "frameStats.h"
 #include "simplePainter.h"
 #include "qualityglPainter.h"
 
@@ -248,8 +249,6 @@ void QualityGLPainterPrivate::renderScene()
       }
     }
   }
-
-  SDL_GL_SwapBuffers();
 }
 
 // -----------------------------------------------------------------
@@ -284,6 +283,7 @@ SDL_Surface *QualityGLPainter::createWindow( int w, int h, bool fullscreen )
     surfaceFlags |= SDL_FULLSCREEN;
   }
 
+  SDL_GL_SetAttribute( SDL_GL_SWAP_CONTROL, vsync() ? 1 : 0 );
   SDL_Surface *display = SDL_SetVideoMode( w, h, 0, surfaceFlags );
 
   if (!display) {
@@ -301,5 +301,8 @@ void QualityGLPainter::begin_impl()
 void QualityGLPainter::end_impl()
 {
   d->renderScene();
+
+  PhaseTimer timer( frameStats(), FrameStats::FlipPhase );
+  SDL_GL_SwapBuffers();
 }
 
@@ -15,6 +15,8 @@ struct SDL_Surface;
 class ScreenPainter : public AbstractPainter
 {
   public:
+    ScreenPainter() : m_vsync(false) {/* */};
+
     /// sets the surface that will be painted on
     virtual void setSDLSurface( SDL_Surface *surface ) = 0;
 
@@ -29,11 +31,18 @@ class ScreenPainter : public AbstractPainter
     /// Handle making windows
     virtual SDL_Surface *createWindow( int x, int y, bool fullscreen ) = 0;
 
+    /// ask for buffer swaps to wait on the vertical retrace, before createWindow
+    void setVSync( bool vsync ) { m_vsync = vsync; };
+
+    /// accessor
+    bool vsync() const { return m_vsync; };
+
   protected:
     virtual int currentTime();
 
   private:
     bool m_blinkOn;
+    bool m_vsync;
 };
 
 #endif // SCREEN_PAINTER_H
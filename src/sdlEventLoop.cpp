@@ -7,12 +7,13 @@
 
 #include <cassert>
 #include <SDL.h>
-#include <SDL_thread.h>
 
 #include "defines.h"
 #include "zstring.h"
+#include "abstractPainter.h"
 #include "freezztManager.h"
 #include "sdlManager.h"
+#include "frameScheduler.h"
 #include "sdlEventLoop.h"
 
 static void translateSDLKeyToZZT( const SDL_keysym &keysym,
@@ -75,131 +76,6 @@ static void translateSDLKeyToZZT( const SDL_keysym &keysym,
 
 // ---------------------------------------------------------------------------
 
-enum {
-  USERCODE_NO_EVENT = 0,
-  USERCODE_FRAMEUPDATE = 1,
-  USERCODE_KEYUPDATE = 2
-};
-
-class MutexLocker
-{
-  public:
-    MutexLocker( SDL_mutex *m ) : mutex(m) { if (mutex) SDL_mutexP(mutex); };
-    ~MutexLocker() { if (mutex) SDL_mutexV(mutex); };
-  private:
-    SDL_mutex *mutex;
-};
-
-class UpdateThread
-{
-  public:
-    // GUI THREAD CODE
-    UpdateThread();
-    ~UpdateThread() { stop(); };
-
-    void start();
-    void stop();
-    bool started() const { return m_started; };
-
-    void setLatency( Uint32 latency );
-    void setEvent( int event );
-
-  protected:
-    UpdateThread( const UpdateThread &other ) { /* No Copying */ };
-
-    // UPDATE THREAD CODE
-    static Uint32 update_timer_callback(Uint32 interval, void *param);
-    void serviceUpdate();
-
-  private:
-    bool m_started;
-    SDL_TimerID m_id;
-    Uint32 m_latency;
-    Uint32 m_lastClock;
-    int m_event;
-};
-
-UpdateThread::UpdateThread()
-  : m_started( false ),
-    m_id( 0 ),
-    m_latency( 27 ),
-    m_lastClock( 0 ),
-    m_event( USERCODE_NO_EVENT )
-{
-  /* */
-}
-
-void UpdateThread::start()
-{
-  if ( m_started ) return;
-  m_id = SDL_AddTimer(10, &update_timer_callback, this);
-  m_started = true;
-}
-
-void UpdateThread::stop()
-{
-  if ( !m_started ) return;
-  SDL_RemoveTimer( m_id );
-  m_started = false;
-}
-
-void UpdateThread::setLatency( Uint32 latency )
-{
-  if ( m_started ) return; // Can't update while running.
-  m_latency = latency;
-}
-
-void UpdateThread::setEvent( int event )
-{
-  if ( m_started ) return; // Can't update while running.
-  m_event = event;
-}
-
-void UpdateThread::serviceUpdate()
-{
-  Uint32 clock = SDL_GetTicks();
-  Uint32 interval;
-  if (m_lastClock > clock) {
-    m_lastClock = 0;
-    interval = 0;
-  }
-  else {
-    interval = clock - m_lastClock;
-  }
-
-  // Generate a Update event when enough time has passed.
-  if ( interval < m_latency ) return;
-
-  if ( interval >= m_latency * 5 ) {
-    // Drop lost update when too much time has passed.
-    m_lastClock = clock;
-  }
-  else {
-    m_lastClock += m_latency;
-  }
- 
-  SDL_UserEvent userevent;
-  userevent.type = SDL_USEREVENT;
-  userevent.code = m_event;
-  userevent.data1 = 0;
-  userevent.data2 = 0;
-
-  SDL_Event event;
-  event.type = SDL_USEREVENT;
-  event.user = userevent;
-
-  SDL_PushEvent(&event);
-}
-
-Uint32 UpdateThread::update_timer_callback(Uint32 interval, void *param)
-{
-  UpdateThread *thread = static_cast<UpdateThread *>(param);
-  thread->serviceUpdate();
-  return interval;
-}
-
-// ---------------------------------------------------------------------------
-
 class JoystickHandler
 {
   public:
@@ -312,10 +188,10 @@ class SDLEventLoopPrivate
     SDLManager *pSDLManager;
     AbstractPainter *pPainter;
     bool stop;
-    bool doFrame;
+    bool forcePaint;
 
     JoystickHandler joystickHandler;
-    UpdateThread frameThread;
+    FrameScheduler scheduler;
 
   private:
     SDLEventLoop *self;
@@ -326,10 +202,10 @@ SDLEventLoopPrivate::SDLEventLoopPrivate( SDLEventLoop *pSelf )
     pSDLManager( 0 ),
     pPainter( 0 ),
     stop( false ),
-    doFrame( false ),
+    forcePaint( true ),
     self( pSelf )
 {
-  frameThread.setEvent( USERCODE_FRAMEUPDATE );
+  /* */
 }
 
 void SDLEventLoopPrivate::parseEvent( const SDL_Event &event )
@@ -351,6 +227,7 @@ void SDLEventLoopPrivate::parseEvent( const SDL_Event &event )
           break;
         case Defines::Z_F11:
           pSDLManager->toggleFullScreen();
+          forcePaint = true;
           break;
         default:
           pZZTManager->doKeypress( keycode, unicode );
@@ -376,12 +253,11 @@ void SDLEventLoopPrivate::parseEvent( const SDL_Event &event )
 
     case SDL_VIDEORESIZE:
       pSDLManager->doResize( event.resize.w, event.resize.h ); 
+      forcePaint = true;
       break;
 
-    case SDL_USEREVENT:
-      if ( event.user.code == USERCODE_FRAMEUPDATE ) {
-        doFrame = true;
-      }
+    case SDL_VIDEOEXPOSE:
+      forcePaint = true;
       break;
 
     default: break;
@@ -405,30 +281,40 @@ void SDLEventLoop::exec()
   assert( d->pZZTManager );
   d->pZZTManager->begin();
 
-  d->frameThread.start();
+  d->scheduler.start();
 
   SDL_Event event;
-  int lastClockUpdate = 0;
   while ( !d->stop && !d->pZZTManager->quitting() )
   {
-    SDL_WaitEvent( &event );
-    d->parseEvent( event );
-    if (d->stop) break;
-
     while ( SDL_PollEvent( &event ) ) {
       d->parseEvent( event );
       if (d->stop) break;
     }
+    if (d->stop) break;
 
-    if (d->doFrame) {
+    // update clock, fixed steps
+    const int ticks = d->scheduler.ticksDue();
+    for ( int i = 0; i < ticks; i++ ) {
       d->joystickHandler.generateEvents( d->pZZTManager );
       d->pZZTManager->doUpdate();
+    }
+
+    // present clock, only when something would look different. One paint
+    // covers however many updates we had to catch up on.
+    if ( d->forcePaint ||
+         d->pZZTManager->needsPaint() ||
+         painter()->blinkChanged() ) {
       d->pZZTManager->doPaint( painter() );
-      d->doFrame = false;
+      d->forcePaint = false;
+    }
+
+    if ( ticks == 0 ) {
+      // input gets polled first thing when we wake up
+      d->scheduler.waitForNextTick();
     }
   }
 
-  d->frameThread.stop();
+  d->scheduler.logStats();
 
   d->pZZTManager->end();
 }
@@ -465,11 +351,11 @@ AbstractPainter *SDLEventLoop::painter() const
 
 void SDLEventLoop::setFrameLatency( int milliseconds )
 {
-  bool running = d->frameThread.started();
-  if ( running ) d->frameThread.stop();
-
-  d->frameThread.setLatency( milliseconds );
+  d->scheduler.setTickMicros( milliseconds * 1000 );
+}
 
-  if ( running ) d->frameThread.start();
+void SDLEventLoop::setFrameMicros( int microseconds )
+{
+  d->scheduler.setTickMicros( microseconds );
 }
 
@@ -22,6 +22,7 @@ class SDLEventLoop
     void exec();
 
     void setFrameLatency( int milliseconds );
+    void setFrameMicros( int microseconds );
 
     void setZZTManager( FreeZZTManager *manager );
     FreeZZTManager *zztManager() const;
@@ -24,10 +24,19 @@
 #include "abstractFileModelFactory.h"
 #include "nullMusicStream.h"
 #include "sdlMusicStream.h"
+#include "waveMusicStream.h"
+#include "headlessRunner.h"
+#include "batchRunner.h"
+#include "taskPool.h"
+#include "worldSnapshot.h"
+#include "worldLoader.h"
+#include "worldWriter.h"
+#include "replay.h"
 #include "dotFileParser.h"
 #include "freezztManager.h"
 #include "fileListModel.h"
 #include "gameWorld.h"
+#include "abstractClock.h"
 
 #include "sdlManager.h"
 
@@ -59,6 +68,17 @@ class NormalFileModelFactory : public AbstractFileModelFactory
 
 // ---------------------------------------------------------------------------
 
+class ArchClock : public AbstractClock
+{
+  public:
+    virtual unsigned int currentMicros()
+    {
+      return (unsigned int) ArchUtils::monotonicMicros();
+    };
+};
+
+// ---------------------------------------------------------------------------
+
 class SDLManagerPrivate
 {
   public:
@@ -66,7 +86,12 @@ class SDLManagerPrivate
 
     void parseArgs( int argc, char ** argv );
     void loadSettings();
+    template<typename T> void configureStream( T *stream );
     AbstractMusicStream *createMusicStream();
+    void execRenderWav();
+    bool execReplay();
+    bool execBatch();
+    bool execResave();
     void createPainter();
     void setScreen( int w, int h, bool full );
     void setKeyboardRepeatRate();
@@ -81,8 +106,20 @@ class SDLManagerPrivate
     SDL_Joystick *joystick;
 
     int frameTime;
+    int frameMicros;
     bool ready;
 
+    std::string renderWavFile;
+    int renderTicks;
+    std::string replayFile;
+    bool batch;
+    /// one world of a batch, run in its own process by the batch
+    bool batchWorker;
+    int batchThreads;
+    std::list<std::string> batchFiles;
+    std::string resaveDir;
+    TaskPool *loadPool;
+
     int windowWidth;
     int windowHeight;
     bool fullscreen;
@@ -96,7 +133,13 @@ SDLManagerPrivate::SDLManagerPrivate( SDLManager *pSelf )
     display(0),
     joystick(0),
     frameTime(27),
+    frameMicros(27000),
     ready(false),
+    renderTicks(0),
+    batch(false),
+    batchWorker(false),
+    batchThreads(0),
+    loadPool(0),
     windowWidth( 640 ),
     windowHeight( 400 ),
     fullscreen( false ),
@@ -107,10 +150,89 @@ SDLManagerPrivate::SDLManagerPrivate( SDLManager *pSelf )
 
 void SDLManagerPrivate::parseArgs( int argc, char ** argv )
 {
-  if (argc >= 2) {
-    zinfo() << "Loading" << argv[1];
-    pFreezztManager->loadWorld( argv[1] );
+  const char *worldFile = 0;
+
+  for ( int i = 1; i < argc; i++ ) {
+    const std::string arg = argv[i];
+    if ( arg == "--render-wav" && i+1 < argc ) {
+      renderWavFile = argv[++i];
+    }
+    else if ( arg == "--ticks" && i+1 < argc ) {
+      renderTicks = ZString( argv[++i] ).sint();
+    }
+    else if ( arg == "--record" && i+1 < argc ) {
+      pFreezztManager->setReplayFile( argv[++i] );
+    }
+    else if ( arg == "--replay" && i+1 < argc ) {
+      replayFile = argv[++i];
+    }
+    else if ( arg == "--batch" ) {
+      batch = true;
+    }
+    else if ( arg == "--batch-worker" ) {
+      batchWorker = true;
+    }
+    else if ( arg == "--threads" && i+1 < argc ) {
+      batchThreads = ZString( argv[++i] ).sint();
+    }
+    else if ( arg == "--resave" && i+1 < argc ) {
+      resaveDir = argv[++i];
+    }
+    else if ( arg.compare( 0, 2, "--" ) == 0 ) {
+      zwarn() << "Unknown option" << arg;
+      return;
+    }
+    else {
+      worldFile = argv[i];
+      batchFiles.push_back( worldFile );
+    }
+  }
+
+  if ( !resaveDir.empty() ) {
+    // rewritten one at a time, nothing gets played
+    if ( batchFiles.empty() ) {
+      zerror() << "--resave needs at least one world";
+      return;
+    }
+    ready = true;
+    return;
+  }
+
+  if ( batchWorker ) {
+    if ( batchFiles.size() != 1 ) {
+      zerror() << "--batch-worker runs exactly one world";
+      return;
+    }
+    ready = true;
+    return;
+  }
+
+  if ( batch ) {
+    // every world gets loaded on the pool, none by the manager
+    if ( batchFiles.empty() ) {
+      zerror() << "--batch needs at least one world";
+      return;
+    }
+    ready = true;
+    return;
+  }
+
+  if (worldFile) {
+    zinfo() << "Loading" << worldFile;
+    pFreezztManager->loadWorld( worldFile );
+  }
+
+  if ( !renderWavFile.empty() ) {
+    if ( !worldFile || !pFreezztManager->world() ) {
+      zerror() << "--render-wav needs a world to play";
+      return;
+    }
+    if ( renderTicks <= 0 ) {
+      zerror() << "--render-wav needs a positive --ticks count";
+      return;
+    }
   }
+
   ready = true;
 }
 
@@ -127,20 +249,20 @@ void SDLManagerPrivate::loadSettings()
   frameTime = dotFile.getInt( "video.frame_time", 1, 27 );
   frameTime = boundInt( 1, frameTime, 1000 );
   zdebug() << "frameTime:" << frameTime;
-}
 
-AbstractMusicStream * SDLManagerPrivate::createMusicStream()
-{
-  bool audioEnabled = dotFile.getBool( "audio.enabled", 1, false );
-  zdebug() << "audio.enabled:" << audioEnabled;
+  // finer control, overrides frame_time when present
+  frameMicros = dotFile.getInt( "video.frame_micros", 1, frameTime * 1000 );
+  frameMicros = boundInt( 1000, frameMicros, 1000000 );
+  zdebug() << "frameMicros:" << frameMicros;
 
-  if (!audioEnabled) {
-    return new NullMusicStream();
-  }
+  // before parseArgs loads the command line's world, it reads the cache
+  pFreezztManager->setWorldCache( dotFile.getBool( "world_cache", 1, false ) );
+}
 
-  SDLMusicStream *stream = new SDLMusicStream();
+template<typename T>
+void SDLManagerPrivate::configureStream( T *stream )
+{
   stream->setSampleRate( dotFile.getInt( "audio.freq", 1, 22050 ) );
-  stream->setBufferLength( dotFile.getInt( "audio.buffer", 1, 2048 ) );
   stream->setVolume( dotFile.getInt( "audio.volume", 1, 64 ) );
 
   std::list<std::string> varList;
@@ -151,22 +273,119 @@ AbstractMusicStream * SDLManagerPrivate::createMusicStream()
   varList.push_back("Sawtooth");
   varList.push_back("TriSquare");
 
-  SDLMusicStream::WaveformType wave = SDLMusicStream::Square;
+  typename T::WaveformType wave = T::Square;
   switch ( dotFile.getFromList( "audio.wave", 1, varList ) ) {
-    case 0: wave = SDLMusicStream::None; break;
-    case 1: wave = SDLMusicStream::Sine; break;
-    case 2: wave = SDLMusicStream::Square; break;
-    case 3: wave = SDLMusicStream::Triangle; break;
-    case 4: wave = SDLMusicStream::Sawtooth; break;
-    case 5: wave = SDLMusicStream::TriSquare; break;
+    case 0: wave = T::None; break;
+    case 1: wave = T::Sine; break;
+    case 2: wave = T::Square; break;
+    case 3: wave = T::Triangle; break;
+    case 4: wave = T::Sawtooth; break;
+    case 5: wave = T::TriSquare; break;
     default: break;
   }
   stream->setWaveform( wave );
+}
+
+AbstractMusicStream * SDLManagerPrivate::createMusicStream()
+{
+  bool audioEnabled = dotFile.getBool( "audio.enabled", 1, false );
+  zdebug() << "audio.enabled:" << audioEnabled;
+
+  if (!audioEnabled) {
+    return new NullMusicStream();
+  }
+
+  SDLMusicStream *stream = new SDLMusicStream();
+  configureStream( stream );
+  stream->setBufferLength( dotFile.getInt( "audio.buffer", 1, 2048 ) );
 
   stream->openAudio();
   return stream;
 }
 
+void SDLManagerPrivate::execRenderWav()
+{
+  GameWorld *world = pFreezztManager->world();
+  const int speed = boundInt( 0, dotFile.getInt( "speed", 1, 4 ), 8 );
+
+  // match the live pacing: one exec every speed+1 frames
+  WaveMusicStream stream;
+  configureStream( &stream );
+  stream.setTickRate( 1000000.0 / ( frameMicros * ( speed + 1 ) ) );
+  if ( !stream.openFile( renderWavFile ) ) return;
+
+  HeadlessRunner runner;
+  runner.setMusicStream( &stream );
+  runner.setWorld( world );
+  runner.exec( renderTicks );
+
+  stream.closeFile();
+  world->setMusicStream( 0 );
+}
+
+bool SDLManagerPrivate::execReplay()
+{
+  ReplayFile replay;
+  if ( !replay.load( replayFile ) ) return false;
+
+  // everything comes out of the replay's snapshot
+  GameWorld world;
+  NullMusicStream stream;
+
+  HeadlessRunner runner;
+  runner.setMusicStream( &stream );
+  runner.setWorld( &world );
+  const bool matched = runner.replay( replay );
+  world.setMusicStream( 0 );
+
+  if ( matched ) {
+    zinfo() << "Replay matched" << runner.ticksRun() << "ticks";
+  }
+  return matched;
+}
+
+bool SDLManagerPrivate::execBatch()
+{
+  BatchRunner runner;
+  runner.setThreadCount( batchThreads );
+  if ( renderTicks > 0 ) {
+    runner.setTicks( renderTicks );
+  }
+
+  std::list<std::string>::const_iterator iter;
+  for ( iter = batchFiles.begin(); iter != batchFiles.end(); iter++ ) {
+    runner.addWorld( *iter );
+  }
+
+  runner.exec();
+  return runner.reportResults() == 0;
+}
+
+bool SDLManagerPrivate::execResave()
+{
+  int failures = 0;
+
+  std::list<std::string>::const_iterator iter;
+  for ( iter = batchFiles.begin(); iter != batchFiles.end(); iter++ ) {
+    const std::string::size_type slash = iter->find_last_of( "/\\" );
+    const std::string base = ( slash == std::string::npos )
+                           ? *iter : iter->substr( slash + 1 );
+    const std::string outFile = resaveDir + "/" + base;
+
+    GameWorld *world = WorldLoader::loadWorld( *iter, loadPool );
+    if ( !world || !WorldWriter::saveWorld( world, outFile ) ) {
+      zerror() << "Could not resave" << *iter;
+      failures += 1;
+    }
+    else {
+      zinfo() << "Resaved" << *iter << "as" << outFile;
+    }
+    delete world;
+  }
+
+  return failures == 0;
+}
+
 void SDLManagerPrivate::createPainter()
 {
   std::list<std::string> varList;
@@ -181,6 +400,8 @@ void SDLManagerPrivate::createPainter()
     default:
       painter = new SimplePainter(); break;
   }
+
+  painter->setVSync( dotFile.getBool( "video.vsync", 1, true ) );
 }
 
 void SDLManagerPrivate::setScreen( int w, int h, bool full )
@@ -196,13 +417,13 @@ void SDLManagerPrivate::setKeyboardRepeatRate()
   int interval = SDL_DEFAULT_REPEAT_INTERVAL;
 
   ZString delayStr = dotFile.getValue("keyboard.repeat_delay", 1);
-  if ( delayStr.upper() != "DEFAULT" ) {
+  if ( !delayStr.equalsNoCase( "DEFAULT" ) ) {
     int val = dotFile.getInt("keyboard.repeat_delay", 1, delay);
     if ( val > 0 ) delay = val;
   }
 
   ZString intervalStr = dotFile.getValue("keyboard.repeat_interval", 1);
-  if ( intervalStr.upper() != "DEFAULT" ) {
+  if ( !intervalStr.equalsNoCase( "DEFAULT" ) ) {
     int val = dotFile.getInt("keyboard.repeat_interval", 1, interval);
     if ( val > 0 ) interval = val;
   }
@@ -236,6 +457,15 @@ SDLManager::SDLManager( int argc, char ** argv )
   : d( new SDLManagerPrivate(this) )
 {
   d->pFreezztManager = new FreeZZTManager;
+
+  // big worlds decode their boards side by side
+  const int cores = ArchUtils::processorCount();
+  if ( cores > 1 ) {
+    d->loadPool = new TaskPool( cores );
+    d->pFreezztManager->setTaskPool( d->loadPool );
+  }
+
+  d->loadSettings();
   d->parseArgs( argc, argv );
 }
 
@@ -243,6 +473,8 @@ SDLManager::~SDLManager()
 {
   delete d->pFreezztManager;
   d->pFreezztManager = 0;
+  delete d->loadPool;
+  d->loadPool = 0;
 
   zinfo() << "Quitting SDL.";
   SDL_Quit();
@@ -272,9 +504,29 @@ void SDLManager::toggleFullScreen()
   }
 }
 
-void SDLManager::exec()
+int SDLManager::exec()
 {
-  d->loadSettings();
+  if ( !d->renderWavFile.empty() ) {
+    d->execRenderWav();
+    return 0;
+  }
+
+  if ( !d->replayFile.empty() ) {
+    return d->execReplay() ? 0 : 1;
+  }
+
+  if ( !d->resaveDir.empty() ) {
+    return d->execResave() ? 0 : 1;
+  }
+
+  if ( d->batchWorker ) {
+    return BatchRunner::execWorker( d->batchFiles.front(),
+                                    d->renderTicks > 0 ? d->renderTicks : 1000 );
+  }
+
+  if ( d->batch ) {
+    return d->execBatch() ? 0 : 1;
+  }
 
   // Initialize defaults, Video and Audio subsystems
   zinfo() << "Initializing SDL.";
@@ -284,13 +536,13 @@ void SDLManager::exec()
                       SDL_INIT_JOYSTICK );
   if(ret==-1) { 
     zerror() << "Could not initialize SDL:" << SDL_GetError();
-    return;
+    return 1;
   }
 
   zinfo() << "Creating display surface.";
   d->createPainter();
   d->setScreen( 640, 400, false );
-  if (!d->display) return;
+  if (!d->display) return 1;
 
   SDL_WM_SetCaption("FreeZZT", "FreeZZT");
   SDL_EnableUNICODE(1);
@@ -305,12 +557,20 @@ void SDLManager::exec()
   NormalFileModelFactory fileModelFactory;
   d->pFreezztManager->setFileModelFactory( &fileModelFactory );
 
+  // Profiling clock, for F3's script profile and F2's frame timings
+  ArchClock clock;
+  d->pFreezztManager->setClock( &clock );
+  d->pFreezztManager->setFrameStatsFile( d->dotFile.getValue( "frame_stats_csv", 1 ) );
+  d->painter->setFrameStats( d->pFreezztManager->frameStats() );
+
   // Load speed from settings
   d->pFreezztManager->setSpeed( d->dotFile.getInt( "speed", 1, 4 ) );
+  d->pFreezztManager->setTurboFactor( d->dotFile.getInt( "turbo_factor", 1, 20 ) );
+  d->pFreezztManager->setRewindMemory( d->dotFile.getInt( "rewind_kb", 1, 4096 ) );
 
   zinfo() << "Entering event loop";
   SDLEventLoop eventLoop;
-  eventLoop.setFrameLatency( d->frameTime );
+  eventLoop.setFrameMicros( d->frameMicros );
   eventLoop.setPainter( d->painter );
   eventLoop.setSDLManager( this );
   eventLoop.setZZTManager( d->pFreezztManager );
@@ -319,5 +579,6 @@ void SDLManager::exec()
   delete musicStream;
   d->closeJoystick();
   delete d->painter;
+  return 0;
 }
 
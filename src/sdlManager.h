@@ -17,7 +17,8 @@ class SDLManager
     ~SDLManager();
 
     bool valid() const;
-    void exec();
+    /// runs until quit, returns the process exit status
+    int exec();
     void doResize( int w, int h );
     void toggleFullScreen();
 
@@ -11,6 +11,7 @@
 #include "debug.h"
 #include "zstring.h"
 #include "abstractPainter.h"
+#include "frameStats.h"
 #include "simplePainter.h"
 
 #include "page437_8x16.xbm"
@@ -355,6 +356,7 @@ void SimplePainter::end_impl()
   d->blitter = 0;
 
   if (needFlip) {
+    PhaseTimer timer( frameStats(), FrameStats::FlipPhase );
     SDL_Flip( d->surface );
   }
 }
@@ -0,0 +1,257 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include "debug.h"
+#include "taskPool.h"
+
+// ---------------------------------------------------------------------------
+
+class WorkerQueue
+{
+  public:
+    WorkerQueue() : lock( SDL_CreateMutex() ) { /* */ };
+    ~WorkerQueue() { SDL_DestroyMutex( lock ); };
+
+    SDL_mutex *lock;
+    std::deque<AbstractTask*> tasks;
+};
+
+class TaskPoolPrivate;
+
+class WorkerArgs
+{
+  public:
+    TaskPoolPrivate *pool;
+    int index;
+};
+
+// ---------------------------------------------------------------------------
+
+class TaskPoolPrivate
+{
+  public:
+    TaskPoolPrivate( TaskPool *pSelf );
+    ~TaskPoolPrivate();
+
+    void start( int count );
+    void stop();
+    AbstractTask *take( int index );
+    AbstractTask *popOwn( int index );
+    AbstractTask *steal( int index );
+    void finished();
+
+    static int workerMain( void *data );
+
+  public:
+    std::vector<SDL_Thread*> threads;
+    std::vector<WorkerQueue*> queues;
+    std::vector<WorkerArgs> args;
+
+    // guards everything below
+    SDL_mutex *lock;
+    SDL_cond *workReady;
+    SDL_cond *allDone;
+    int queued;
+    int pending;
+    int nextQueue;
+    bool quitting;
+
+  private:
+    TaskPool *self;
+};
+
+TaskPoolPrivate::TaskPoolPrivate( TaskPool *pSelf )
+  : lock( SDL_CreateMutex() ),
+    workReady( SDL_CreateCond() ),
+    allDone( SDL_CreateCond() ),
+    queued( 0 ),
+    pending( 0 ),
+    nextQueue( 0 ),
+    quitting( false ),
+    self( pSelf )
+{
+  /* */
+}
+
+TaskPoolPrivate::~TaskPoolPrivate()
+{
+  for ( unsigned int i = 0; i < queues.size(); i++ ) {
+    delete queues[i];
+  }
+  SDL_DestroyCond( allDone );
+  SDL_DestroyCond( workReady );
+  SDL_DestroyMutex( lock );
+}
+
+void TaskPoolPrivate::start( int count )
+{
+  queues.resize( count );
+  args.resize( count );
+  for ( int i = 0; i < count; i++ ) {
+    queues[i] = new WorkerQueue;
+    args[i].pool = this;
+    args[i].index = i;
+  }
+
+  // the args vector is done growing, so pointers into it stay put
+  for ( int i = 0; i < count; i++ ) {
+    threads.push_back( SDL_CreateThread( workerMain, &args[i] ) );
+  }
+}
+
+void TaskPoolPrivate::stop()
+{
+  SDL_LockMutex( lock );
+  quitting = true;
+  SDL_CondBroadcast( workReady );
+  SDL_UnlockMutex( lock );
+
+  for ( unsigned int i = 0; i < threads.size(); i++ ) {
+    SDL_WaitThread( threads[i], 0 );
+  }
+  threads.clear();
+}
+
+AbstractTask *TaskPoolPrivate::take( int index )
+{
+  // queued works as a semaphore: once we've claimed one, some queue is
+  // guaranteed to still be holding a task for us.
+  SDL_LockMutex( lock );
+  while ( queued == 0 && !quitting ) {
+    SDL_CondWait( workReady, lock );
+  }
+  if ( queued == 0 ) {
+    SDL_UnlockMutex( lock );
+    return 0;
+  }
+  queued -= 1;
+  SDL_UnlockMutex( lock );
+
+  AbstractTask *task = popOwn( index );
+  while ( !task ) {
+    task = steal( index );
+  }
+  return task;
+}
+
+AbstractTask *TaskPoolPrivate::popOwn( int index )
+{
+  WorkerQueue *queue = queues[index];
+  AbstractTask *task = 0;
+
+  SDL_LockMutex( queue->lock );
+  if ( !queue->tasks.empty() ) {
+    task = queue->tasks.back();
+    queue->tasks.pop_back();
+  }
+  SDL_UnlockMutex( queue->lock );
+
+  return task;
+}
+
+AbstractTask *TaskPoolPrivate::steal( int index )
+{
+  const int count = queues.size();
+  for ( int i = 1; i < count; i++ ) {
+    // take from the far end, away from where the owner is working
+    WorkerQueue *queue = queues[ ( index + i ) % count ];
+    AbstractTask *task = 0;
+
+    SDL_LockMutex( queue->lock );
+    if ( !queue->tasks.empty() ) {
+      task = queue->tasks.front();
+      queue->tasks.pop_front();
+    }
+    SDL_UnlockMutex( queue->lock );
+
+    if ( task ) return task;
+  }
+  return 0;
+}
+
+void TaskPoolPrivate::finished()
+{
+  SDL_LockMutex( lock );
+  pending -= 1;
+  if ( pending == 0 ) {
+    SDL_CondBroadcast( allDone );
+  }
+  SDL_UnlockMutex( lock );
+}
+
+int TaskPoolPrivate::workerMain( void *data )
+{
+  WorkerArgs *args = static_cast<WorkerArgs*>( data );
+  TaskPoolPrivate *pool = args->pool;
+
+  while ( AbstractTask *task = pool->take( args->index ) ) {
+    task->run();
+    pool->finished();
+  }
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+TaskPool::TaskPool( int threads )
+  : d( new TaskPoolPrivate(this) )
+{
+  d->start( threads > 0 ? threads : 1 );
+  zinfo() << "TaskPool started" << threadCount() << "threads";
+}
+
+TaskPool::~TaskPool()
+{
+  wait();
+  d->stop();
+  delete d;
+  d = 0;
+}
+
+int TaskPool::threadCount() const
+{
+  return d->queues.size();
+}
+
+void TaskPool::add( AbstractTask *task )
+{
+  assert( task );
+
+  SDL_LockMutex( d->lock );
+  const int index = d->nextQueue;
+  d->nextQueue = ( d->nextQueue + 1 ) % d->queues.size();
+  SDL_UnlockMutex( d->lock );
+
+  WorkerQueue *queue = d->queues[index];
+  SDL_LockMutex( queue->lock );
+  queue->tasks.push_back( task );
+  SDL_UnlockMutex( queue->lock );
+
+  // only announce it once it's actually sitting in a queue
+  SDL_LockMutex( d->lock );
+  d->queued += 1;
+  d->pending += 1;
+  SDL_CondSignal( d->workReady );
+  SDL_UnlockMutex( d->lock );
+}
+
+void TaskPool::wait()
+{
+  SDL_LockMutex( d->lock );
+  while ( d->pending > 0 ) {
+    SDL_CondWait( d->allDone, d->lock );
+  }
+  SDL_UnlockMutex( d->lock );
+}
+
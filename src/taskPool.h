@@ -0,0 +1,37 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include "abstractTaskPool.h"
+
+class TaskPoolPrivate;
+
+/// Fixed set of worker threads. Every worker has its own queue, and
+/// steals from the others when it runs out.
+class TaskPool : public AbstractTaskPool
+{
+  public:
+    TaskPool( int threads );
+    virtual ~TaskPool();
+
+    /// accessor
+    virtual int threadCount() const;
+
+    /// queues a task, the caller keeps ownership
+    virtual void add( AbstractTask *task );
+
+    /// blocks until every queued task has finished running
+    virtual void wait();
+
+  private:
+    TaskPoolPrivate *d;
+};
+
+#endif // TASK_POOL_H
+
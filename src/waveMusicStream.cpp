@@ -0,0 +1,292 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <list>
+#include <fstream>
+
+#include <SDL.h>
+
+#include "debug.h"
+#include "zstring.h"
+#include "abstractMusicStream.h"
+#include "musicSynth.h"
+#include "waveMusicStream.h"
+
+using namespace std;
+
+static const int WAV_HEADER_SIZE = 44;
+static const unsigned int FLUSH_SIZE = 65536;
+
+// ---------------------------------------------------------------------------
+
+class WaveMusicStreamPrivate
+{
+  public:
+    WaveMusicStreamPrivate();
+    ~WaveMusicStreamPrivate() {/* */};
+
+    void writeHeader( unsigned char *header ) const;
+    void renderSamples( int samples );
+    void flush();
+
+  public:
+    bool opened;
+    int hertz;
+    int volume;
+    WaveMusicStream::WaveformType waveformType;
+    float tickRate;
+    float sampleRemainder;
+
+    NoteList noteBuffer;
+    bool clearBuffer;
+
+    AudioThread audioThread;
+    vector<Sint8> scratch;
+
+    ofstream file;
+    bool toMemory;
+    vector<unsigned char> output;
+    unsigned int samplesRendered;
+};
+
+WaveMusicStreamPrivate::WaveMusicStreamPrivate()
+  : opened( false ),
+    hertz( 44100 ),
+    volume( 64 ),
+    waveformType( WaveMusicStream::Square ),
+    tickRate( 18.2 ),
+    sampleRemainder( 0.0 ),
+    clearBuffer( false ),
+    toMemory( true ),
+    samplesRendered( 0 )
+{
+  /* */
+}
+
+static void putLE( unsigned char *p, unsigned int value, int bytes )
+{
+  for ( int i = 0; i < bytes; i++ ) {
+    p[i] = ( value >> (i*8) ) & 0xFF;
+  }
+}
+
+void WaveMusicStreamPrivate::writeHeader( unsigned char *header ) const
+{
+  // canonical RIFF header for 8-bit unsigned mono PCM
+  memcpy( header + 0, "RIFF", 4 );
+  putLE( header + 4, 36 + samplesRendered, 4 );
+  memcpy( header + 8, "WAVEfmt ", 8 );
+  putLE( header + 16, 16, 4 );
+  putLE( header + 20, 1, 2 );
+  putLE( header + 22, 1, 2 );
+  putLE( header + 24, hertz, 4 );
+  putLE( header + 28, hertz, 4 );
+  putLE( header + 32, 1, 2 );
+  putLE( header + 34, 8, 2 );
+  memcpy( header + 36, "data", 4 );
+  putLE( header + 40, samplesRendered, 4 );
+}
+
+void WaveMusicStreamPrivate::renderSamples( int samples )
+{
+  if ( samples <= 0 ) return;
+
+  scratch.assign( samples, 0 );
+  audioThread.playback( &scratch[0], samples );
+
+  // wav wants 8-bit samples unsigned
+  const unsigned int start = output.size();
+  output.resize( start + samples );
+  for ( int i = 0; i < samples; i++ ) {
+    output[start+i] = (unsigned char)( scratch[i] + 128 );
+  }
+  samplesRendered += samples;
+
+  if ( !toMemory && output.size() >= FLUSH_SIZE ) {
+    flush();
+  }
+}
+
+void WaveMusicStreamPrivate::flush()
+{
+  if ( toMemory || output.empty() ) return;
+  file.write( (const char *) &output[0], output.size() );
+  output.clear();
+}
+
+// ---------------------------------------------------------------------------
+
+WaveMusicStream::WaveMusicStream()
+  : AbstractMusicStream(),
+    d( new WaveMusicStreamPrivate )
+{
+  /* */
+}
+
+WaveMusicStream::~WaveMusicStream()
+{
+  if ( d->opened ) {
+    closeFile();
+  }
+  delete d;
+  d = 0;
+}
+
+void WaveMusicStream::setSampleRate( int hertz )
+{
+  d->hertz = hertz <  8000 ?  8000
+           : hertz > 96000 ? 96000
+           : hertz;
+}
+
+void WaveMusicStream::setVolume( int volume )
+{
+  d->volume = volume <   0 ? 0
+            : volume > 255 ? 255
+            : volume;
+}
+
+void WaveMusicStream::setWaveform( WaveformType type )
+{
+  d->waveformType = type;
+}
+
+void WaveMusicStream::setTickRate( float ticksPerSecond )
+{
+  if ( ticksPerSecond <= 0.0 ) return;
+  d->tickRate = ticksPerSecond;
+}
+
+bool WaveMusicStream::openFile( const std::string &filename )
+{
+  if ( d->opened ) {
+    closeFile();
+  }
+
+  d->toMemory = filename.empty();
+  d->output.clear();
+  d->samplesRendered = 0;
+  d->sampleRemainder = 0.0;
+
+  // reserve space for the header, it gets filled in on close
+  d->output.resize( WAV_HEADER_SIZE, 0 );
+
+  if ( !d->toMemory ) {
+    d->file.open( filename.c_str(), ios::out|ios::binary|ios::trunc );
+    if ( !d->file.is_open() ) {
+      zwarn() << "WaveMusicStream: could not open" << filename;
+      d->output.clear();
+      return false;
+    }
+    d->flush();
+  }
+
+  zinfo() << "WaveMusicStream::openFile"
+          << ( d->toMemory ? "<memory>" : filename )
+          << d->hertz << d->volume << d->waveformType;
+
+  d->audioThread = AudioThread( d->hertz, 0, d->volume,
+                                AbstractBufferFiller::create( d->waveformType ) );
+  d->opened = true;
+  return true;
+}
+
+void WaveMusicStream::closeFile()
+{
+  if ( !d->opened ) return;
+
+  // let the tail of whatever was queued play out
+  int leftover = d->audioThread.currentNote.bytesLeft;
+  NoteList::const_iterator iter;
+  for ( iter = d->audioThread.noteRoll.begin();
+        iter != d->audioThread.noteRoll.end(); ++iter ) {
+    leftover += (*iter).bytesLeft;
+  }
+  d->renderSamples( leftover );
+
+  if ( d->toMemory ) {
+    d->writeHeader( &d->output[0] );
+  }
+  else {
+    d->flush();
+    unsigned char header[WAV_HEADER_SIZE];
+    d->writeHeader( header );
+    d->file.seekp( 0, ios::beg );
+    d->file.write( (const char *) header, WAV_HEADER_SIZE );
+    d->file.close();
+  }
+
+  zinfo() << "WaveMusicStream::closeFile" << d->samplesRendered << "samples";
+
+  delete d->audioThread.bufferFiller;
+  d->audioThread = AudioThread();
+  d->noteBuffer.clear();
+  d->opened = false;
+}
+
+const std::vector<unsigned char> &WaveMusicStream::buffer() const
+{
+  return d->output;
+}
+
+unsigned int WaveMusicStream::samplesRendered() const
+{
+  return d->samplesRendered;
+}
+
+void WaveMusicStream::begin_impl()
+{
+  /* */
+}
+
+void WaveMusicStream::end_impl()
+{
+  if (d->clearBuffer) {
+    d->audioThread.noteRoll.clear();
+    d->audioThread.currentNote.bytesLeft = 0;
+    d->clearBuffer = false;
+  }
+  d->audioThread.noteRoll.splice( d->audioThread.noteRoll.end(), d->noteBuffer );
+
+  if ( !d->opened ) return;
+
+  // one game tick of audio, carrying the fraction so long renders don't drift
+  const float exact = (float) d->hertz / d->tickRate + d->sampleRemainder;
+  const int samples = (int) exact;
+  d->sampleRemainder = exact - samples;
+  d->renderSamples( samples );
+}
+
+void WaveMusicStream::clear()
+{
+  d->clearBuffer = true;
+}
+
+bool WaveMusicStream::hasNotes() const
+{
+  return !d->noteBuffer.empty() ||
+         !d->audioThread.noteRoll.empty() ||
+         d->audioThread.currentNote.bytesLeft > 0;
+}
+
+void WaveMusicStream::addNote( bool tone, int key, int ticks )
+{
+  // same timing as the live stream, so renders line up with playback
+  int bytes = (int)((float) d->hertz / 18.2 * ticks);
+  Note note;
+  if (tone) {
+    note = Note::createNote( Note::keyFrequency( key ), bytes );
+  }
+  else {
+    note = Note::createEffect( key, bytes );
+  }
+  d->noteBuffer.push_back( note );
+}
+
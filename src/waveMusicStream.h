@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __WAVE_MUSIC_STREAM_H__
+#define __WAVE_MUSIC_STREAM_H__
+
+#include <string>
+#include <vector>
+
+#include "abstractMusicStream.h"
+
+class WaveMusicStreamPrivate;
+
+/// Renders music to a WAV, one game tick at a time, without an audio device
+class WaveMusicStream : public AbstractMusicStream
+{
+  public:
+    WaveMusicStream();
+    virtual ~WaveMusicStream();
+
+    void setSampleRate( int hertz );
+    void setVolume( int volume );
+
+    enum WaveformType {
+      None = 0,
+      Sine,
+      Square,
+      Triangle,
+      Sawtooth,
+      TriSquare
+    };
+
+    void setWaveform( WaveformType type );
+
+    /// how many game ticks make up a second of audio, defaults to 18.2
+    void setTickRate( float ticksPerSecond );
+
+    /// render to a wav file on disk, empty filename renders to memory
+    bool openFile( const std::string &filename );
+    /// flushes leftover notes and finishes the wav
+    void closeFile();
+
+    /// accessor for the complete wav when rendering to memory
+    const std::vector<unsigned char> &buffer() const;
+
+    /// number of samples rendered so far
+    unsigned int samplesRendered() const;
+
+  protected:
+    virtual void begin_impl();
+    virtual void clear();
+    virtual bool hasNotes() const;
+    virtual void addNote( bool tone, int key, int ticks );
+    virtual void end_impl();
+
+  private:
+    WaveMusicStreamPrivate *d;
+};
+
+#endif /* __WAVE_MUSIC_STREAM_H__ */
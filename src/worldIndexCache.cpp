@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <string>
+#include <map>
+#include <fstream>
+
+#include "debug.h"
+#include "zstring.h"
+#include "snapshotStream.h"
+#include "worldIndex.h"
+#include "worldIndexCache.h"
+
+static const char cacheMagic[] = "ZIDX";
+static const unsigned short cacheVersion = 1;
+
+struct WorldIndexEntry
+{
+  long long mtime;
+  long long size;
+  /// false for files that failed to scan, so they aren't tried again
+  bool valid;
+  WorldIndex index;
+};
+
+typedef std::map<ZString, WorldIndexEntry> WorldIndexMap;
+
+// ---------------------------------------------------------------------------
+
+class WorldIndexCachePrivate
+{
+  public:
+    WorldIndexCachePrivate()
+      : dirty( false )
+    { /* */ };
+
+  public:
+    ZString filename;
+    WorldIndexMap entries;
+    bool dirty;
+};
+
+// ---------------------------------------------------------------------------
+
+WorldIndexCache::WorldIndexCache()
+  : d( new WorldIndexCachePrivate )
+{
+  /* */
+}
+
+WorldIndexCache::~WorldIndexCache()
+{
+  delete d;
+  d = 0;
+}
+
+void WorldIndexCache::load( const ZString &filename )
+{
+  using namespace std;
+
+  d->filename = filename;
+  d->entries.clear();
+  d->dirty = false;
+
+  ifstream file( filename.c_str(), ios::in|ios::binary|ios::ate );
+  if ( !file.is_open() || !file.good() ) {
+    return;
+  }
+  SnapshotBytes bytes( file.tellg() );
+  file.seekg( 0, ios::beg );
+  if ( !bytes.empty() ) {
+    file.read( (char *) &bytes[0], bytes.size() );
+  }
+
+  SnapshotReader in( bytes.empty() ? 0 : &bytes[0], bytes.size() );
+  const unsigned char *magic = in.getBytes( 4 );
+  if ( !magic || ZString( (const char *) magic, 4 ) != cacheMagic ||
+       in.getWord() != cacheVersion ) {
+    zwarn() << "WorldIndexCache: ignoring" << filename;
+    return;
+  }
+
+  const unsigned int count = in.getDWord();
+  for ( unsigned int i = 0; i < count && in.ok(); i++ ) {
+    const ZString path = in.getString();
+    WorldIndexEntry &entry = d->entries[path];
+    entry.mtime = in.getDWord();
+    entry.mtime |= (long long) in.getDWord() << 32;
+    entry.size = in.getDWord();
+    entry.valid = in.getBool();
+    if ( entry.valid ) {
+      entry.index.deserialize( in );
+    }
+  }
+
+  if ( !in.ok() ) {
+    zwarn() << "WorldIndexCache: truncated" << filename;
+    d->entries.clear();
+    return;
+  }
+
+  zinfo() << "WorldIndexCache: loaded" << d->entries.size() << "entries";
+}
+
+bool WorldIndexCache::save()
+{
+  if ( !d->dirty || d->filename.empty() ) return true;
+
+  SnapshotBytes bytes;
+  SnapshotWriter out( bytes );
+  out.putBytes( (const unsigned char *) cacheMagic, 4 );
+  out.putWord( cacheVersion );
+
+  out.putDWord( d->entries.size() );
+  for ( WorldIndexMap::const_iterator it = d->entries.begin();
+        it != d->entries.end(); ++it )
+  {
+    const WorldIndexEntry &entry = it->second;
+    out.putString( it->first );
+    out.putDWord( entry.mtime & 0xffffffff );
+    out.putDWord( entry.mtime >> 32 );
+    out.putDWord( entry.size );
+    out.putBool( entry.valid );
+    if ( entry.valid ) {
+      entry.index.serialize( out );
+    }
+  }
+
+  std::ofstream file( d->filename.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+  if ( !file.is_open() ) {
+    zwarn() << "WorldIndexCache: couldn't write" << d->filename;
+    return false;
+  }
+  file.write( (const char *) &bytes[0], bytes.size() );
+  if ( !file.good() ) return false;
+
+  d->dirty = false;
+  return true;
+}
+
+const WorldIndex *WorldIndexCache::lookup( const ZString &path,
+                                           long long mtime, long long size )
+{
+  WorldIndexMap::iterator it = d->entries.find( path );
+  if ( it != d->entries.end() &&
+       it->second.mtime == mtime &&
+       it->second.size == size )
+  {
+    return it->second.valid ? &it->second.index : 0;
+  }
+
+  WorldIndexEntry &entry = d->entries[path];
+  entry.mtime = mtime;
+  entry.size = size;
+  entry.valid = entry.index.scan( path );
+  d->dirty = true;
+
+  zdebug() << "WorldIndexCache: scanned" << path << entry.valid;
+  return entry.valid ? &entry.index : 0;
+}
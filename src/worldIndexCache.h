@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef WORLD_INDEX_CACHE_H
+#define WORLD_INDEX_CACHE_H
+
+class ZString;
+class WorldIndex;
+class WorldIndexCachePrivate;
+
+/// WorldIndex of every world file seen so far, kept on disk between runs.
+/// Entries are keyed by path and go stale when the file's mtime or size
+/// changes, so only new and edited worlds ever get scanned.
+class WorldIndexCache
+{
+  public:
+    WorldIndexCache();
+    ~WorldIndexCache();
+
+    /// reads the cache file, a missing or bad one just starts empty
+    void load( const ZString &filename );
+    /// writes back to where it was loaded from, if anything changed
+    bool save();
+
+    /// index of the world at path, scanning it if the cache is stale.
+    /// mtime and size come from the caller's stat, returns 0 for non-worlds.
+    const WorldIndex *lookup( const ZString &path, long long mtime, long long size );
+
+  private:
+    WorldIndexCachePrivate *d;
+
+    /// disabled copy constructor
+    WorldIndexCache(const WorldIndexCache &);
+    /// disabled assignment operator
+    WorldIndexCache & operator=(const WorldIndexCache &);
+};
+
+#endif // WORLD_INDEX_CACHE_H
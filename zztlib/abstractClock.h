@@ -0,0 +1,19 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef ABSTRACT_CLOCK_H
+#define ABSTRACT_CLOCK_H
+
+/// microsecond time source for the profilers, the platform provides one
+class AbstractClock
+{
+  public:
+    virtual ~AbstractClock() { /* */ };
+    virtual unsigned int currentMicros() = 0;
+};
+
+#endif // ABSTRACT_CLOCK_H
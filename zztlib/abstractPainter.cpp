@@ -11,19 +11,25 @@
 #include "debug.h"
 #include "zstring.h"
 #include "abstractPainter.h"
+#include "frameStats.h"
 
-void AbstractPainter::begin()
+bool AbstractPainter::blinkPhase()
 {
   // 2 hertz sound good?
   const int rate = 2;
   int clock = currentTime();
-  m_blinkOn = ( clock % (1000 / rate) ) / (500 / rate);
+  return ( clock % (1000 / rate) ) / (500 / rate);
+}
 
+void AbstractPainter::begin()
+{
+  m_blinkOn = blinkPhase();
   begin_impl();
 }
 
 void AbstractPainter::end()
 {
+  PhaseTimer timer( m_frameStats, FrameStats::PainterEndPhase );
   end_impl();
 }
 
@@ -32,6 +38,11 @@ bool AbstractPainter::blinkOn() const
   return m_blinkOn;
 };
 
+bool AbstractPainter::blinkChanged()
+{
+  return blinkPhase() != m_blinkOn;
+}
+
 void AbstractPainter::drawText( int x, int y,
                                 unsigned char color,
                                 const ZString &text )
@@ -9,13 +9,15 @@
 #define ABSTRACT_PAINTER_H
 
 class ZString;
+class FrameStats;
 
 /// Painting interface to abstract away screen drawing details
 class AbstractPainter
 {
   public:
     AbstractPainter()
-      : m_blinkOn(false)
+      : m_blinkOn(false),
+        m_frameStats(0)
     {/* */};
 
     /// begin will be called before any painting is started
@@ -39,6 +41,14 @@ class AbstractPainter
     /// blink cycle Draw Foregound when false, Draw background only when true
     bool blinkOn() const;
 
+    /// true when a paint right now would show a different blink cycle
+    bool blinkChanged();
+
+    /// end and the buffer swap get timed into these, 0 for no timing
+    void setFrameStats( FrameStats *stats ) { m_frameStats = stats; };
+    /// accessor
+    FrameStats *frameStats() const { return m_frameStats; };
+
   protected:
     /// begin template method calls begin_impl
     virtual void begin_impl() {/* */};
@@ -49,8 +59,12 @@ class AbstractPainter
     /// access needed to a millisecond clock for blinking. think SDL_GetTicks
     virtual int currentTime() = 0;
 
+  private:
+    bool blinkPhase();
+
   private:
     bool m_blinkOn;
+    FrameStats *m_frameStats;
 };
 
 #endif // ABSTRACT_PAINTER_H
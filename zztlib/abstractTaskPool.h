@@ -0,0 +1,38 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef ABSTRACT_TASK_POOL_H
+#define ABSTRACT_TASK_POOL_H
+
+/// A unit of work handed to an AbstractTaskPool
+class AbstractTask
+{
+  public:
+    virtual ~AbstractTask() { /* */ };
+
+    /// called once, on one of the pool's threads
+    virtual void run() = 0;
+};
+
+/// Threads to run tasks on, the platform provides one
+class AbstractTaskPool
+{
+  public:
+    virtual ~AbstractTaskPool() { /* */ };
+
+    /// accessor
+    virtual int threadCount() const = 0;
+
+    /// queues a task, the caller keeps ownership
+    virtual void add( AbstractTask *task ) = 0;
+
+    /// blocks until every queued task has finished running.
+    /// Not for calling from inside a task.
+    virtual void wait() = 0;
+};
+
+#endif // ABSTRACT_TASK_POOL_H
@@ -7,22 +7,261 @@
 
 #include <iostream>
 #include <string>
+#include <cstring>
 #include "debug.h"
+#include "zstring.h"
 
 DebuggingStream::LogLevel DebuggingStream::m_globalLogLevel = DebuggingStream::NONE;
 
+// ---------------------------------------------------------------------------
+
+/// Bounded ring of finished lines, any thread can push without a lock.
+/// Each slot's sequence number says whose turn it is: a pusher may fill
+/// it when it equals the push position, the reader may empty it when it's
+/// one past. Only one thread reads at a time, so every thread's lines
+/// come out in the order it wrote them.
+class LogRing
+{
+  public:
+    enum { SLOTS = 1024, LINE_MAX = 240 };
+
+    LogRing();
+
+    /// false when the ring is full or the line doesn't fit a slot
+    bool push( const char *text, unsigned int length );
+    /// false when the ring is empty, otherwise line is overwritten
+    bool pop( std::string &line );
+
+    /// one reader at a time, spins until it's this thread's turn
+    void lockReader();
+    void unlockReader();
+
+  private:
+    struct Slot
+    {
+      unsigned int sequence;
+      unsigned int length;
+      char text[LINE_MAX];
+    };
+
+    Slot slots[SLOTS];
+    unsigned int pushPos;
+    unsigned int popPos;
+    int reading;
+};
+
+LogRing::LogRing()
+  : pushPos(0),
+    popPos(0),
+    reading(0)
+{
+  for ( unsigned int i = 0; i < SLOTS; i++ ) {
+    slots[i].sequence = i;
+    slots[i].length = 0;
+  }
+}
+
+bool LogRing::push( const char *text, unsigned int length )
+{
+  if ( length > LINE_MAX ) return false;
+
+  Slot *slot;
+  unsigned int pos = __atomic_load_n( &pushPos, __ATOMIC_RELAXED );
+  while ( true ) {
+    slot = &slots[ pos % SLOTS ];
+    const unsigned int seq = __atomic_load_n( &slot->sequence, __ATOMIC_ACQUIRE );
+    const int diff = (int) ( seq - pos );
+    if ( diff == 0 ) {
+      // on failure pos gets the current value, try again from there
+      if ( __atomic_compare_exchange_n( &pushPos, &pos, pos + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED ) ) break;
+    }
+    else if ( diff < 0 ) {
+      return false;
+    }
+    else {
+      pos = __atomic_load_n( &pushPos, __ATOMIC_RELAXED );
+    }
+  }
+
+  memcpy( slot->text, text, length );
+  slot->length = length;
+  __atomic_store_n( &slot->sequence, pos + 1, __ATOMIC_RELEASE );
+  return true;
+}
+
+bool LogRing::pop( std::string &line )
+{
+  Slot *slot = &slots[ popPos % SLOTS ];
+  const unsigned int seq = __atomic_load_n( &slot->sequence, __ATOMIC_ACQUIRE );
+  if ( seq != popPos + 1 ) return false;
+
+  line.assign( slot->text, slot->length );
+  __atomic_store_n( &slot->sequence, popPos + SLOTS, __ATOMIC_RELEASE );
+  popPos += 1;
+  return true;
+}
+
+void LogRing::lockReader()
+{
+  while ( __atomic_exchange_n( &reading, 1, __ATOMIC_ACQUIRE ) ) {
+    /* */
+  }
+}
+
+void LogRing::unlockReader()
+{
+  __atomic_store_n( &reading, 0, __ATOMIC_RELEASE );
+}
+
+static LogRing logRing;
+static bool logBuffered = false;
+static bool logDropping = false;
+static unsigned int logDropped = 0;
+
+/// writes out the ring, caller holds the reader lock
+static int writeRing()
+{
+  int count = 0;
+  std::string line;
+  std::string out;
+  while ( logRing.pop( line ) ) {
+    out += line;
+    count += 1;
+  }
+  if ( count > 0 ) {
+    std::cout.write( out.data(), out.size() );
+    std::cout.flush();
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+
+void DebuggingStream::setBuffered( bool buffered )
+{
+  __atomic_store_n( &logBuffered, buffered, __ATOMIC_RELEASE );
+  if ( !buffered ) {
+    flushBuffered();
+  }
+}
+
+bool DebuggingStream::buffered()
+{
+  return __atomic_load_n( &logBuffered, __ATOMIC_ACQUIRE );
+}
+
+int DebuggingStream::flushBuffered()
+{
+  logRing.lockReader();
+  const int count = writeRing();
+  logRing.unlockReader();
+  return count;
+}
+
+void DebuggingStream::setDropping( bool dropping )
+{
+  __atomic_store_n( &logDropping, dropping, __ATOMIC_RELEASE );
+}
+
+unsigned int DebuggingStream::droppedLines()
+{
+  return __atomic_load_n( &logDropped, __ATOMIC_RELAXED );
+}
+
+// ---------------------------------------------------------------------------
+
+DebuggingStream &DebuggingStream::operator<<( const ZString &inVal )
+{
+  if (!isLoggable()) return *this;
+  appendPretty( inVal.data(), inVal.size() );
+  return *this;
+}
+
+void DebuggingStream::appendPretty( const char *text, unsigned int length )
+{
+  const unsigned int start = m_buffer.size();
+  m_buffer.append( text, length );
+  for ( unsigned int i = start; i < m_buffer.size(); i++ ) {
+    if ( m_buffer[i] < ' ' && m_buffer[i] != '\n' ) m_buffer[i] = '?';
+  }
+  m_buffer.append( 1, ' ' );
+}
+
+void DebuggingStream::appendNumber( long value )
+{
+  if ( value < 0 ) {
+    // negate in unsigned, so the most negative long survives
+    appendNumber( 0ul - (unsigned long) value, true );
+  }
+  else {
+    appendNumber( (unsigned long) value, false );
+  }
+}
+
+void DebuggingStream::appendNumber( unsigned long value, bool negative )
+{
+  char digits[24];
+  int i = sizeof(digits);
+  digits[--i] = ' ';
+  do {
+    digits[--i] = '0' + ( value % 10 );
+    value /= 10;
+  } while ( value > 0 );
+  if ( negative ) {
+    digits[--i] = '-';
+  }
+  m_buffer.append( digits + i, sizeof(digits) - i );
+}
+
+// ---------------------------------------------------------------------------
+
 DebuggingStream::~DebuggingStream()
 {
 #if DEBUGGING_ENABLED
   if ( isLoggable() ) {
+    std::string line;
     switch (m_level) {
-      case ERRORS: std::cout << "ERROR: "; break;
-      case WARNINGS: std::cout << "WARNING: "; break;
-      case DEBUGGING: std::cout << "DEBUG: "; break;
-      case INFORMATIVE: std::cout << "INFO: "; break;
+      case ERRORS: line = "ERROR: "; break;
+      case WARNINGS: line = "WARNING: "; break;
+      case DEBUGGING: line = "DEBUG: "; break;
+      case INFORMATIVE: line = "INFO: "; break;
       default: break;
     }
-    std::cout << m_buffer << "\n";
+    line += m_buffer;
+    line += "\n";
+
+    if ( !buffered() ) {
+      // one write per line, so lines from other threads don't get spliced in
+      std::cout << line;
+      return;
+    }
+
+    // too long for a slot, it never goes through the ring. Empty the
+    // ring ourselves first so this thread's lines stay in order.
+    if ( line.size() > LogRing::LINE_MAX ) {
+      logRing.lockReader();
+      writeRing();
+      std::cout << line;
+      std::cout.flush();
+      logRing.unlockReader();
+      return;
+    }
+
+    if ( logRing.push( line.data(), line.size() ) ) return;
+
+    // only a full ring counts as a drop
+    if ( __atomic_load_n( &logDropping, __ATOMIC_ACQUIRE ) ) {
+      __atomic_add_fetch( &logDropped, 1, __ATOMIC_RELAXED );
+      return;
+    }
+
+    logRing.lockReader();
+    writeRing();
+    if ( !logRing.push( line.data(), line.size() ) ) {
+      std::cout << line;
+    }
+    logRing.unlockReader();
   }
 #endif
 }
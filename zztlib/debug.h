@@ -11,7 +11,24 @@
 #include <ostream>
 #include <iostream>
 #include <sstream>
+#include <string>
+
+class ZString;
+
+/// 0 drops every log line at compile time
+#ifndef DEBUGGING_ENABLED
 #define  DEBUGGING_ENABLED  1
+#endif
+
+/// zdebug() lines sit in the interpreter's inner loops. Release builds
+/// drop them at compile time, define this to 1 to keep them anyway.
+#ifndef DEBUGGING_HOTPATH
+#  ifdef NDEBUG
+#    define  DEBUGGING_HOTPATH  0
+#  else
+#    define  DEBUGGING_HOTPATH  1
+#  endif
+#endif
 
 /// debugging class for writing to stdout
 class DebuggingStream
@@ -25,9 +42,33 @@ class DebuggingStream
       INFORMATIVE
     };
 
+    /// set once at startup, before any threads are running
     static void setGlobalLevel( LogLevel level ) { m_globalLogLevel = level; };
     static LogLevel globalLevel() { return m_globalLogLevel; };
 
+    /// false when the level was compiled out or is filtered at runtime
+    static inline bool isLevelLoggable( LogLevel level )
+    {
+      if ( !DEBUGGING_ENABLED ) return false;
+      if ( level == DEBUGGING && !DEBUGGING_HOTPATH ) return false;
+      return ( level <= m_globalLogLevel );
+    };
+
+    /// finished lines go into a lock-free ring instead of straight to
+    /// stdout, someone has to call flushBuffered() now and then.
+    /// Turning it off flushes what's left.
+    static void setBuffered( bool buffered );
+    static bool buffered();
+
+    /// writes out the lines waiting in the ring, returns how many
+    static int flushBuffered();
+
+    /// with a writer thread draining the ring, a full ring drops the line
+    /// instead of making the logging thread wait on stdout
+    static void setDropping( bool dropping );
+    /// lines lost to a full ring since startup
+    static unsigned int droppedLines();
+
   public:
     inline DebuggingStream( LogLevel level )
       : m_level(level) { /* */ };
@@ -48,17 +89,55 @@ class DebuggingStream
       return *this;
     }
  
-    /// specialized
+    /// specialized, the common cases skip the stringstream
     inline DebuggingStream &operator<<(const std::string &inVal)
     {
       if (!isLoggable()) return *this;
-      std::stringstream stream;
-      std::string pretty = inVal;
-      for ( unsigned int i = 0; i < pretty.size(); i++ ) {
-        if ( pretty[i] < ' ' && pretty[i] != '\n' ) pretty[i] = '?';
-      }
-      stream << pretty << " ";
-      m_buffer.append(stream.str());
+      appendPretty( inVal.data(), inVal.size() );
+      return *this;
+    }
+
+    /// specialized
+    DebuggingStream &operator<<(const ZString &inVal);
+
+    /// specialized
+    inline DebuggingStream &operator<<(const char *inVal)
+    {
+      if (!isLoggable()) return *this;
+      m_buffer.append(inVal);
+      m_buffer.append(1, ' ');
+      return *this;
+    }
+
+    /// specialized
+    inline DebuggingStream &operator<<(int inVal)
+    {
+      if (!isLoggable()) return *this;
+      appendNumber( inVal );
+      return *this;
+    }
+
+    /// specialized
+    inline DebuggingStream &operator<<(unsigned int inVal)
+    {
+      if (!isLoggable()) return *this;
+      appendNumber( (unsigned long) inVal, false );
+      return *this;
+    }
+
+    /// specialized
+    inline DebuggingStream &operator<<(long inVal)
+    {
+      if (!isLoggable()) return *this;
+      appendNumber( inVal );
+      return *this;
+    }
+
+    /// specialized
+    inline DebuggingStream &operator<<(unsigned long inVal)
+    {
+      if (!isLoggable()) return *this;
+      appendNumber( inVal, false );
       return *this;
     }
 
@@ -72,35 +151,36 @@ class DebuggingStream
       return *this;
     }
 
+  private:
+    void appendPretty( const char *text, unsigned int length );
+    void appendNumber( long value );
+    void appendNumber( unsigned long value, bool negative );
+
   private:
     LogLevel m_level;
     std::string m_buffer;
     static LogLevel m_globalLogLevel;
 };
 
-/// convienience function, prefer using this 
-inline DebuggingStream zinfo()
-{
-  return ( DebuggingStream(DebuggingStream::INFORMATIVE) );
-}
+/// the stream only gets built, and the arguments after it only get
+/// evaluated, when the level is loggable. A for instead of an if, so an
+/// else after it can't pair up with the wrong statement.
+#define ZLOG( level ) \
+  for ( bool zlogOnce = DebuggingStream::isLevelLoggable( level ); \
+        zlogOnce; zlogOnce = false ) \
+    DebuggingStream( level )
 
-/// convienience function, prefer using this 
-inline DebuggingStream zdebug()
-{
-  return ( DebuggingStream(DebuggingStream::DEBUGGING) );
-}
+/// convienience macro, prefer using this 
+#define zinfo()   ZLOG( DebuggingStream::INFORMATIVE )
 
-/// convienience function, prefer using this 
-inline DebuggingStream zwarn()
-{
-  return ( DebuggingStream(DebuggingStream::WARNINGS) );
-}
+/// convienience macro, prefer using this 
+#define zdebug()  ZLOG( DebuggingStream::DEBUGGING )
 
-/// convienience function, prefer using this 
-inline DebuggingStream zerror()
-{
-  return ( DebuggingStream(DebuggingStream::ERRORS) );
-}
+/// convienience macro, prefer using this 
+#define zwarn()   ZLOG( DebuggingStream::WARNINGS )
+
+/// convienience macro, prefer using this 
+#define zerror()  ZLOG( DebuggingStream::ERRORS )
 
 inline std::ostream &zout()
 {
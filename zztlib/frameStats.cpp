@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "debug.h"
+#include "defines.h"
+#include "zstring.h"
+#include "abstractClock.h"
+#include "frameStats.h"
+
+FrameStats::FrameStats()
+  : m_clock( 0 ),
+    m_enabled( false )
+{
+  for ( int p = 0; p < PHASE_COUNT; p++ ) {
+    PhaseSamples &phase = m_phases[p];
+    std::fill( phase.window, phase.window + WINDOW, 0 );
+    std::fill( phase.buckets, phase.buckets + BUCKETS, 0 );
+    phase.next = 0;
+    phase.count = 0;
+    phase.maximum = 0;
+    phase.total = 0;
+  }
+}
+
+unsigned int FrameStats::currentMicros() const
+{
+  return m_clock ? m_clock->currentMicros() : 0;
+}
+
+void FrameStats::addSample( Phase phase, unsigned int micros )
+{
+  PhaseSamples &samples = m_phases[phase];
+  samples.window[ samples.next ] = micros;
+  samples.next = ( samples.next + 1 ) % WINDOW;
+  samples.count += 1;
+  samples.total += micros;
+  samples.maximum = std::max( samples.maximum, micros );
+
+  // bucket b holds everything under 2^b microseconds
+  int bucket = 0;
+  while ( bucket < BUCKETS - 1 && ( micros >> bucket ) > 0 ) {
+    bucket += 1;
+  }
+  samples.buckets[bucket] += 1;
+}
+
+unsigned int FrameStats::percentile( Phase phase, int percent ) const
+{
+  const PhaseSamples &samples = m_phases[phase];
+  const unsigned int size = std::min( samples.count, (unsigned int) WINDOW );
+  if ( size == 0 ) return 0;
+
+  unsigned int sorted[WINDOW];
+  std::copy( samples.window, samples.window + size, sorted );
+  const unsigned int rank = ( ( size - 1 ) * boundInt( 0, percent, 100 ) ) / 100;
+  std::nth_element( sorted, sorted + rank, sorted + size );
+  return sorted[rank];
+}
+
+unsigned int FrameStats::sampleCount( Phase phase ) const
+{
+  return m_phases[phase].count;
+}
+
+const char *FrameStats::phaseName( Phase phase )
+{
+  switch ( phase ) {
+    case UpdatePhase:     return "Update";
+    case WorldExecPhase:  return "World";
+    case BoardExecPhase:  return "Board";
+    case BoardPaintPhase: return "Paint";
+    case PainterEndPhase: return "End";
+    case FlipPhase:       return "Flip";
+    default: break;
+  }
+  return "";
+}
+
+bool FrameStats::writeCSV( const ZString &filename ) const
+{
+  std::ofstream file( filename.c_str(), std::ios::out|std::ios::trunc );
+  if ( !file.is_open() ) {
+    zwarn() << "FrameStats: couldn't write" << filename;
+    return false;
+  }
+
+  file << "phase,samples,mean_us,max_us,p50_us,p99_us";
+  for ( int b = 0; b < BUCKETS - 1; b++ ) {
+    file << ",under_" << ( 1u << b ) << "us";
+  }
+  file << ",longer";
+  file << "\n";
+
+  for ( int p = 0; p < PHASE_COUNT; p++ ) {
+    const Phase phase = (Phase) p;
+    const PhaseSamples &samples = m_phases[p];
+    const unsigned long long mean = samples.count ? samples.total / samples.count : 0;
+    file << phaseName( phase ) << ","
+         << samples.count << ","
+         << mean << ","
+         << samples.maximum << ","
+         << percentile( phase, 50 ) << ","
+         << percentile( phase, 99 );
+    for ( int b = 0; b < BUCKETS; b++ ) {
+      file << "," << samples.buckets[b];
+    }
+    file << "\n";
+  }
+
+  zinfo() << "FrameStats: wrote" << filename;
+  return file.good();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+class AbstractClock;
+class ZString;
+
+/// Timings for each phase of a frame. Keeps the latest samples for
+/// percentiles, plus a power of two histogram over the whole session.
+class FrameStats
+{
+  public:
+    enum Phase {
+      UpdatePhase,       ///< FreeZZTManager::doUpdate
+      WorldExecPhase,    ///< GameWorld::exec
+      BoardExecPhase,    ///< GameBoard::exec
+      BoardPaintPhase,   ///< GameBoard::paint
+      PainterEndPhase,   ///< AbstractPainter::end, includes the flip
+      FlipPhase,         ///< SDL_Flip or SDL_GL_SwapBuffers
+      PHASE_COUNT
+    };
+
+    enum { WINDOW = 128, BUCKETS = 24 };
+
+    FrameStats();
+
+    /// nothing gets timed without one
+    void setClock( AbstractClock *clock ) { m_clock = clock; };
+
+    /// timers only take readings while enabled
+    void setEnabled( bool enabled ) { m_enabled = enabled; };
+    bool enabled() const { return m_enabled && m_clock; };
+
+    unsigned int currentMicros() const;
+    void addSample( Phase phase, unsigned int micros );
+
+    /// over the latest WINDOW samples, percent from 0 to 100
+    unsigned int percentile( Phase phase, int percent ) const;
+
+    /// samples taken since startup
+    unsigned int sampleCount( Phase phase ) const;
+
+    /// short name, fits the sidebar
+    static const char *phaseName( Phase phase );
+
+    /// one row per phase: totals, window percentiles, histogram buckets
+    bool writeCSV( const ZString &filename ) const;
+
+  private:
+    class PhaseSamples
+    {
+      public:
+        unsigned int window[WINDOW];
+        unsigned int next;
+        unsigned int count;
+        unsigned int maximum;
+        unsigned long long total;
+        unsigned int buckets[BUCKETS];
+    };
+
+    PhaseSamples m_phases[PHASE_COUNT];
+    AbstractClock *m_clock;
+    bool m_enabled;
+};
+
+/// times its own scope into one phase, costs a pointer check when off
+class PhaseTimer
+{
+  public:
+    PhaseTimer( FrameStats *stats, FrameStats::Phase phase )
+      : m_stats( stats && stats->enabled() ? stats : 0 ),
+        m_phase( phase ),
+        m_start( m_stats ? m_stats->currentMicros() : 0 )
+    { /* */ };
+
+    ~PhaseTimer()
+    {
+      if ( !m_stats ) return;
+      m_stats->addSample( m_phase, m_stats->currentMicros() - m_start );
+    };
+
+  private:
+    FrameStats *m_stats;
+    FrameStats::Phase m_phase;
+    unsigned int m_start;
+};
+
+#endif // FRAME_STATS_H
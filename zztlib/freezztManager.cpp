@@ -23,6 +23,10 @@
 #include "abstractFileModelFactory.h"
 #include "scrollView.h"
 #include "gameWidgets.h"
+#include "worldSnapshot.h"
+#include "rewindBuffer.h"
+#include "replay.h"
+#include "frameStats.h"
 #include "gameControllers.h"
 
 #include "freezztManager.h"
@@ -39,6 +43,8 @@ class FreeZZTManagerPrivate
 
   public:
     ControllerShare share;
+    AbstractTaskPool *taskPool;
+    bool worldCache;
     bool begun;
 
   private:
@@ -46,7 +52,9 @@ class FreeZZTManagerPrivate
 };
 
 FreeZZTManagerPrivate::FreeZZTManagerPrivate( FreeZZTManager *pSelf )
-  : begun(false),
+  : taskPool(0),
+    worldCache(false),
+    begun(false),
     self(pSelf)
 {
   /* */
@@ -67,6 +75,7 @@ void FreeZZTManagerPrivate::cycleControllers()
   share.nextController->enter( self, &share );
 
   share.currentController = share.nextController;
+  share.dirty = true;
 }
 
 // ---------------------------------------------------------------------------
@@ -84,7 +93,8 @@ FreeZZTManager::~FreeZZTManager()
 
 void FreeZZTManager::loadWorld( const char *filename )
 {
-  GameWorld *world = WorldLoader::loadWorld( filename );
+  GameWorld *world = WorldLoader::loadWorld( filename, d->taskPool,
+                                                d->worldCache );
 
   if (!world) {
     zwarn() << "World not loaded:" << filename;
@@ -109,8 +119,20 @@ void FreeZZTManager::setWorld( GameWorld *world )
 
   world->setFrameCycle( d->share.titleModeInfoBarWidget.framerateSliderWidget.value() );
   world->setCurrentBoard( world->getBoard(0) );
+  if ( d->share.world ) {
+    d->share.world->setRewindBuffer( 0 );
+    d->share.world->setScriptClock( 0 );
+    d->share.world->setFrameStats( 0 );
+  }
+
   world->setScrollView( &d->share.scrollView );
+  world->setRewindBuffer( &d->share.rewindBuffer );
   d->share.playModeInfoBarWidget.setWorld(world);
+  d->share.scriptProfileWidget.setWorld(world);
+  d->share.showScriptProfile = false;
+  world->setFrameStats( &d->share.frameStats );
+  d->share.quickSave.clear();
+  d->share.rewindBuffer.clear();
 
   d->share.world = world;
 }
@@ -125,6 +147,33 @@ void FreeZZTManager::setMusicStream( AbstractMusicStream *stream )
   d->share.musicStream = stream;
 }
 
+void FreeZZTManager::setTaskPool( AbstractTaskPool *pool )
+{
+  d->taskPool = pool;
+}
+
+void FreeZZTManager::setWorldCache( bool enabled )
+{
+  d->worldCache = enabled;
+}
+
+void FreeZZTManager::setClock( AbstractClock *clock )
+{
+  d->share.clock = clock;
+  d->share.frameStats.setClock( clock );
+}
+
+FrameStats *FreeZZTManager::frameStats() const
+{
+  return &d->share.frameStats;
+}
+
+void FreeZZTManager::setFrameStatsFile( const ZString &filename )
+{
+  d->share.frameStatsFile = filename;
+  d->share.frameStats.setEnabled( d->share.showFrameStats || !filename.empty() );
+}
+
 void FreeZZTManager::setSpeed( int value )
 {
   value = boundInt( 0, value, 8 );
@@ -134,15 +183,32 @@ void FreeZZTManager::setSpeed( int value )
   }
 }
 
+void FreeZZTManager::setTurboFactor( int factor )
+{
+  d->share.turboFactor = boundInt( 2, factor, 1000 );
+}
+
+void FreeZZTManager::setRewindMemory( int kilobytes )
+{
+  d->share.rewindBuffer.setMemoryLimit( boundInt( 0, kilobytes, 1024 * 1024 ) * 1024 );
+}
+
+void FreeZZTManager::setReplayFile( const ZString &filename )
+{
+  d->share.replayFile = filename;
+}
+
 void FreeZZTManager::doKeypress( int keycode, int unicode )
 {
   d->share.currentController->doKeypress( keycode, unicode );
+  d->share.dirty = true;
   d->cycleControllers();
 }
 
 void FreeZZTManager::doUpdate()
 {
   assert( d->begun );
+  PhaseTimer timer( &d->share.frameStats, FrameStats::UpdatePhase );
   d->share.currentController->doUpdate();
   d->cycleControllers();
 }
@@ -153,6 +219,12 @@ void FreeZZTManager::doPaint( AbstractPainter *painter )
   painter->begin();
   d->share.currentController->doPaint( painter );
   painter->end();
+  d->share.dirty = false;
+}
+
+bool FreeZZTManager::needsPaint() const
+{
+  return d->share.dirty;
 }
 
 void FreeZZTManager::begin()
@@ -160,11 +232,11 @@ void FreeZZTManager::begin()
   assert( !d->begun );
 
   if ( d->share.world ) {
-    d->share.nextController = TitleController::create();
+    d->share.nextController = &d->share.titleController;
   }
   else {
     setWorld( GameWorld::createEmptyWorld() );
-    d->share.nextController = WorldMenuController::create();
+    d->share.nextController = &d->share.worldMenuController;
   }
 
   d->share.world->setMusicStream( d->share.musicStream );
@@ -177,6 +249,12 @@ void FreeZZTManager::end()
 {
   assert( d->begun );
   d->begun = false;
+  if ( d->share.replayRecorder.isRecording() ) {
+    d->share.replayRecorder.end( d->share.replayFile );
+  }
+  if ( !d->share.frameStatsFile.empty() ) {
+    d->share.frameStats.writeCSV( d->share.frameStatsFile );
+  }
   d->share.world->setMusicStream( 0 );
 }
 
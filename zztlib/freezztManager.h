@@ -11,6 +11,9 @@
 class AbstractPainter;
 class AbstractMusicStream;
 class AbstractFileModelFactory;
+class AbstractClock;
+class AbstractTaskPool;
+class FrameStats;
 class GameWorld;
 class FreeZZTManagerPrivate;
 
@@ -36,9 +39,33 @@ class FreeZZTManager
     /// Set factory
     void setMusicStream( AbstractMusicStream *stream );
 
+    /// worlds get their boards decoded on this pool, if set
+    void setTaskPool( AbstractTaskPool *pool );
+
+    /// worlds loaded from here on keep a parsed copy beside their file
+    void setWorldCache( bool enabled );
+
+    /// time source for the F3 script profile and the F2 frame timings
+    void setClock( AbstractClock *clock );
+
+    /// frame timings, hand this to the painter so it can time its end
+    FrameStats *frameStats() const;
+
+    /// times every frame and writes the timings to this CSV file on end
+    void setFrameStatsFile( const ZString &filename );
+
     /// set speed visible on title screen, 0 to 8
     void setSpeed( int value );
 
+    /// cycles per update when turbo is toggled on during play
+    void setTurboFactor( int factor );
+
+    /// memory kept for stepping back with Backspace, 0 turns it off
+    void setRewindMemory( int kilobytes );
+
+    /// records the first play session to this file
+    void setReplayFile( const ZString &filename );
+
     /// begins the game state machine, call before any of the do functions.
     void begin();
 
@@ -51,6 +78,9 @@ class FreeZZTManager
     /// event loop triggers frame redraw
     void doPaint( AbstractPainter *painter );
 
+    /// true when the screen changed since the last doPaint
+    bool needsPaint() const;
+
     /// ends the game state machine, call on shutdown.
     void end();
 
@@ -9,9 +9,12 @@
 #include <vector>
 #include <string>
 #include <cassert>
+#include <algorithm>
 
 #include "debug.h"
 #include "zstring.h"
+#include "zstringView.h"
+#include "symbolTable.h"
 #include "defines.h"
 #include "gameBoard.h"
 #include "gameWorld.h"
@@ -22,8 +25,14 @@
 #include "scriptable.h"
 #include "zztoopInterp.h"
 #include "player.h"
+#include "snapshotStream.h"
+#include "thingFactory.h"
+#include "zztStructs.h"
+#include "frameStats.h"
 
 const int FIELD_SIZE = 1500;
+// bytes per cell, as SnapshotTable::writeEntity writes them
+const int SNAPSHOT_CELL_SIZE = 5;
 
 typedef std::list<ZZTThing::AbstractThing*> ThingList;
 typedef std::list<ZZTOOP::Interpreter*> ProgramsList;
@@ -36,7 +45,13 @@ class GameBoardPrivate
     virtual ~GameBoardPrivate();
 
     void collectGarbage();
+    void deleteContents();
+    void refreshThings();
     void drawMessageLine( AbstractPainter *painter );
+    void writeField( SnapshotWriter &out, const ZZTThing::SnapshotTable &table,
+                     bool packed ) const;
+    bool readField( const unsigned char *bytes, int length,
+                    const ZZTThing::SnapshotTable &table, bool packed );
 
   public:
     GameWorld *world;
@@ -45,19 +60,26 @@ class GameBoardPrivate
 
     ThingList thingList;
     ThingList thingGarbage;
+    /// front of thingList, looked up once instead of on every player()
+    ZZTThing::Player *player;
 
     ProgramsList programs;
 
     unsigned int boardCycle;
+    unsigned int revision;
+    ScriptStats scriptStats;
 
     ZString message;
     int messageLife;
+    ZString title;
 
     int northExit;
     int southExit;
     int westExit;
     int eastExit;
     bool darkness;
+    std::vector<unsigned char> fileInfo;
+    std::vector<UnknownThing> unknownThings;
 
   private:
     GameBoard *self;
@@ -65,7 +87,9 @@ class GameBoardPrivate
 
 GameBoardPrivate::GameBoardPrivate( GameBoard *pSelf )
   : world(0),
+    player(0),
     boardCycle(0),
+    revision(0),
     messageLife(0),
     northExit(0),
     southExit(0),
@@ -78,8 +102,26 @@ GameBoardPrivate::GameBoardPrivate( GameBoard *pSelf )
 }
 
 GameBoardPrivate::~GameBoardPrivate()
+{
+  deleteContents();
+  self = 0;
+}
+
+void GameBoardPrivate::refreshThings()
+{
+  // copy thing characters out to entities, and let each exec once more
+  ThingList::iterator iter;
+  for( iter = thingList.begin(); iter != thingList.end(); ++iter )
+  {
+    ZZTThing::AbstractThing *thing = *iter;
+    thing->updateEntity();
+  }
+}
+
+void GameBoardPrivate::deleteContents()
 {
   // clean out the thing list
+  player = 0;
   while ( !thingList.empty() ) {
     ZZTThing::AbstractThing *thing = thingList.front();
     thingList.pop_front();
@@ -93,8 +135,6 @@ GameBoardPrivate::~GameBoardPrivate()
     programs.pop_front();
     delete prog;
   }
-
-  self = 0;
 }
 
 void GameBoardPrivate::collectGarbage()
@@ -143,6 +183,81 @@ static bool beyondVisible( const int x, const int y, const int px, const int py
   return torchShape[dy][dx]=='#';
 }
 
+static bool sameCell( const ZZTEntity &a, const ZZTEntity &b )
+{
+  return a.id() == b.id() && a.color() == b.color() &&
+         a.tile() == b.tile() && a.thing() == b.thing();
+}
+
+void GameBoardPrivate::writeField( SnapshotWriter &out,
+                                   const ZZTThing::SnapshotTable &table,
+                                   bool packed ) const
+{
+  if ( !packed ) {
+    for ( int i = 0; i < FIELD_SIZE; i++ ) {
+      table.writeEntity( out, field[i] );
+    }
+    return;
+  }
+
+  // runs of the same cell, led by their length in bytes
+  SnapshotBytes runs;
+  SnapshotWriter runOut( runs );
+  int i = 0;
+  while ( i < FIELD_SIZE ) {
+    int run = 1;
+    while ( run < 255 && i + run < FIELD_SIZE &&
+            sameCell( field[i + run], field[i] ) ) {
+      run += 1;
+    }
+    runOut.putByte( run );
+    table.writeEntity( runOut, field[i] );
+    i += run;
+  }
+
+  out.putWord( runs.size() );
+  out.putBytes( &runs[0], runs.size() );
+}
+
+bool GameBoardPrivate::readField( const unsigned char *bytes, int length,
+                                  const ZZTThing::SnapshotTable &table,
+                                  bool packed )
+{
+  if ( packed ) {
+    // the run length, then the cell the way writeEntity put it
+    const unsigned char *end = bytes + length;
+    int i = 0;
+    while ( i < FIELD_SIZE ) {
+      if ( end - bytes < 1 + SNAPSHOT_CELL_SIZE || bytes[0] == 0 ) {
+        return false;
+      }
+      ZZTEntity entity( bytes[1], bytes[2], bytes[3] );
+      entity.setThing( table.thing( (signed short)( bytes[4] | bytes[5] << 8 ) ) );
+      const int run = std::min( (int) bytes[0], FIELD_SIZE - i );
+      std::fill( field.begin() + i, field.begin() + i + run, entity );
+      bytes += 1 + SNAPSHOT_CELL_SIZE;
+      i += run;
+    }
+    return true;
+  }
+
+  SnapshotReader in( bytes, length );
+
+  // boards are mostly long stretches of the same cell, and those
+  // don't need decoding again
+  const unsigned char *cell = bytes;
+  for ( int i = 0; i < FIELD_SIZE; i++, cell += SNAPSHOT_CELL_SIZE ) {
+    if ( i > 0 && std::equal( cell, cell + SNAPSHOT_CELL_SIZE,
+                              cell - SNAPSHOT_CELL_SIZE ) ) {
+      field[i] = field[i-1];
+      in.getBytes( SNAPSHOT_CELL_SIZE );
+      continue;
+    }
+    field[i] = table.readEntity( in );
+  }
+  return in.ok();
+}
+
 // ---------------------------------------------------------------------------
 
 GameBoard::GameBoard()
@@ -203,6 +318,7 @@ AbstractMusicStream *GameBoard::musicStream() const
 
 void GameBoard::clear()
 {
+  d->revision += 1;
   for ( int x = 0; x < FIELD_SIZE; x++ ) {
     d->field[x] = ZZTEntity();
   }
@@ -221,21 +337,36 @@ void GameBoard::setEntity( int x, int y, const ZZTEntity &entity )
   if ( x < 0 || x >= 60 || y < 0 || y >= 25 ) {
     return;
   }
+  d->revision += 1;
 
   d->field[ fieldHash(x, y) ] = entity;
 }
 
+void GameBoard::fillEntities( int index, int count, const ZZTEntity &entity )
+{
+  const int begin = std::max( index, 0 );
+  const int end = std::min( index + count, FIELD_SIZE );
+  if ( begin >= end ) {
+    return;
+  }
+  d->revision += 1;
+
+  std::fill( d->field.begin() + begin, d->field.begin() + end, entity );
+}
+
 void GameBoard::replaceEntity( int x, int y, const ZZTEntity &newEntity )
 {
   if ( x < 0 || x >= 60 || y < 0 || y >= 25 ) {
     return;
   }
+  d->revision += 1;
 
   const int index = fieldHash(x, y);
   ZZTThing::AbstractThing *thing = d->field[index].thing();
 
   if ( thing ) {
     // wipe it from existance
+    if ( thing == d->player ) d->player = 0;
     d->thingList.remove( thing );
     d->thingGarbage.push_back( thing );
     thing = 0;    
@@ -251,6 +382,11 @@ void GameBoard::clearEntity( int x, int y )
 
 void GameBoard::exec()
 {
+  PhaseTimer timer( d->world ? d->world->frameStats() : 0, FrameStats::BoardExecPhase );
+  d->revision += 1;
+  // every cycle re-arms things, painted or not. turbo batches and catch up
+  // after a stall run several cycles between paints.
+  d->refreshThings();
   for ( int i = 0; i<FIELD_SIZE; i++ ) {
     d->field[i].exec();
   }
@@ -263,13 +399,9 @@ void GameBoard::exec()
 
 void GameBoard::paint( AbstractPainter *painter )
 {
-  // copy thing characters out to entities
-  ThingList::iterator iter;
-  for( iter = d->thingList.begin(); iter != d->thingList.end(); ++iter )
-  {
-    ZZTThing::AbstractThing *thing = *iter;
-    thing->updateEntity();
-  }
+  PhaseTimer timer( d->world ? d->world->frameStats() : 0, FrameStats::BoardPaintPhase );
+  d->revision += 1;
+  d->refreshThings();
 
   ZZTThing::Player *plyr = player();
   const int px = plyr->xPos();
@@ -310,6 +442,7 @@ const ZString & GameBoard::message() const
 
 void GameBoard::setMessage( const ZString &mesg )
 {
+  d->revision += 1;
   d->message.clear();
   if ( mesg.empty() ) {
     d->messageLife = 0;
@@ -322,21 +455,59 @@ void GameBoard::setMessage( const ZString &mesg )
   }
 }
 
+int GameBoard::messageLife() const
+{
+  return d->messageLife;
+}
+
+const ZString &GameBoard::title() const
+{
+  return d->title;
+}
+
+void GameBoard::setTitle( const ZString &title )
+{
+  d->title = title;
+}
+
 int GameBoard::northExit() const { return d->northExit; }
 int GameBoard::southExit() const { return d->southExit; }
 int GameBoard::westExit() const { return d->westExit; } 
 int GameBoard::eastExit() const { return d->eastExit; }
 
-void GameBoard::setNorthExit( int exit ) { d->northExit = exit; }
-void GameBoard::setSouthExit( int exit ) { d->southExit = exit; }
-void GameBoard::setWestExit( int exit ) { d->westExit = exit; }
-void GameBoard::setEastExit( int exit ) { d->eastExit = exit; }
+void GameBoard::setNorthExit( int exit ) { d->northExit = exit; d->revision += 1; }
+void GameBoard::setSouthExit( int exit ) { d->southExit = exit; d->revision += 1; }
+void GameBoard::setWestExit( int exit ) { d->westExit = exit; d->revision += 1; }
+void GameBoard::setEastExit( int exit ) { d->eastExit = exit; d->revision += 1; }
 
 bool GameBoard::isDark() const { return d->darkness; }
-void GameBoard::setDark( bool dark ) { d->darkness = dark; };
+void GameBoard::setDark( bool dark ) { d->darkness = dark; d->revision += 1; };
+
+void GameBoard::setFileInfo( const unsigned char *data, int length )
+{
+  d->fileInfo.assign( data, data + length );
+}
+
+const std::vector<unsigned char> &GameBoard::fileInfo() const
+{
+  return d->fileInfo;
+}
+
+void GameBoard::addUnknownThing( unsigned char id, const unsigned char *data, int length )
+{
+  d->unknownThings.push_back( UnknownThing() );
+  d->unknownThings.back().id = id;
+  d->unknownThings.back().bytes.assign( data, data + length );
+}
+
+const std::vector<UnknownThing> &GameBoard::unknownThings() const
+{
+  return d->unknownThings;
+}
 
 void GameBoard::addThing( ZZTThing::AbstractThing *thing )
 {
+  d->revision += 1;
   d->thingList.push_back( thing );
 
   ZZTEntity &ent = d->field[ fieldHash( thing->xPos(), thing->yPos() ) ];
@@ -347,6 +518,7 @@ void GameBoard::addThing( ZZTThing::AbstractThing *thing )
 
 void GameBoard::addInterpreter( ZZTOOP::Interpreter *interp )
 {
+  d->revision += 1;
   // Gameboard owns the programs, not the Scriptable Objects
   d->programs.push_back( interp );
 
@@ -366,6 +538,7 @@ void GameBoard::addInterpreter( ZZTOOP::Interpreter *interp )
 
 void GameBoard::moveThing( ZZTThing::AbstractThing *thing, int newX, int newY )
 {
+  d->revision += 1;
   if ( newX < 0 || newX >= 60 || newY < 0 || newY >= 25 ) {
     return;
   }
@@ -392,6 +565,7 @@ void GameBoard::moveThing( ZZTThing::AbstractThing *thing, int newX, int newY )
 void GameBoard::switchThings( ZZTThing::AbstractThing *left,
                               ZZTThing::AbstractThing *right )
 {
+  d->revision += 1;
   // get their positions
   int lx = left->xPos(),
       ly = left->yPos(),
@@ -421,6 +595,7 @@ void GameBoard::switchThings( ZZTThing::AbstractThing *left,
 
 void GameBoard::makeBullet( int x, int y, int x_step, int y_step, bool playerType )
 {
+  d->revision += 1;
   if ( x < 0 || x >= 60 || y < 0 || y >= 25 ) {
     return;
   }
@@ -491,6 +666,7 @@ void GameBoard::handleBulletCollision( int x, int y, int x_step, int y_step, boo
 
 void GameBoard::makeStar( int x, int y )
 {
+  d->revision += 1;
   if ( x < 0 || x >= 60 || y < 0 || y >= 25 ) {
     return;
   }
@@ -514,7 +690,9 @@ void GameBoard::makeStar( int x, int y )
 
 void GameBoard::deleteThing( ZZTThing::AbstractThing *thing )
 {
+  d->revision += 1;
   thing->handleDeleted();
+  if ( thing == d->player ) d->player = 0;
   d->thingList.remove( thing );
   d->thingGarbage.push_back( thing );
   d->field[ fieldHash(thing->xPos(), thing->yPos()) ] = thing->underEntity();
@@ -529,12 +707,16 @@ ZZTThing::Player *GameBoard::player() const
 {
   assert( d->thingList.size() > 0 );
 
-  ZZTThing::Player *player =
-    dynamic_cast<ZZTThing::Player *>(d->thingList.front());
+  // seek, aligned and contact ask for this from every creature, every
+  // cycle, so the cast only happens again after the player's removed.
+  if ( !d->player ) {
+    d->player = dynamic_cast<ZZTThing::Player *>(d->thingList.front());
+  }
 
-  assert( player );
+  assert( d->player );
+  assert( d->player == d->thingList.front() );
 
-  return player;
+  return d->player;
 }
 
 void GameBoard::pushEntities( int x, int y, int x_step, int y_step )
@@ -602,12 +784,13 @@ void GameBoard::pushEntities( int x, int y, int x_step, int y_step )
   setEntity( x, y, ZZTEntity::createEntity( ZZTEntity::EmptySpace, 0x07 ) );
 }
 
-void GameBoard::sendLabel( const ZString &to, const ZString &label,
+void GameBoard::sendLabel( const ZStringView &to, const ZStringView &label,
                            const ZZTThing::AbstractThing *from )
 {
-  ZString upperTo = to.upper();
-  const bool toAll = ( upperTo == "ALL" );
-  const bool toOthers = ( upperTo == "OTHERS" );
+  d->revision += 1;
+  const int toSymbol = d->world->symbols().intern( to );
+  const bool toAll = ( toSymbol == SymbolTable::All );
+  const bool toOthers = ( toSymbol == SymbolTable::Others );
 
   ThingList::iterator iter;
   for( iter = d->thingList.begin(); iter != d->thingList.end(); ++iter )
@@ -617,9 +800,8 @@ void GameBoard::sendLabel( const ZString &to, const ZString &label,
       continue;
 
     ZZTThing::ScriptableThing *object = dynamic_cast<ZZTThing::ScriptableThing*>(thing);
-    const ZString upperName = object->objectName().upper();
 
-    if ( toAll || upperTo == upperName ||
+    if ( toAll || toSymbol == object->nameSymbol() ||
          (toOthers && (from != thing)) )
     {
       object->seekLabel( label );
@@ -646,3 +828,169 @@ bool GameBoard::isAnyEntity( unsigned char id, unsigned char color ) const
   return false;
 }
 
+
+unsigned int GameBoard::revision() const
+{
+  return d->revision;
+}
+
+const ScriptStats &GameBoard::scriptStats() const
+{
+  return d->scriptStats;
+}
+
+void GameBoard::addScriptStats( const ScriptStats &stats )
+{
+  d->scriptStats.add( stats );
+}
+
+void GameBoard::fillSnapshotTable( ZZTThing::SnapshotTable &table ) const
+{
+  table.things.assign( d->thingList.begin(), d->thingList.end() );
+  table.programs.assign( d->programs.begin(), d->programs.end() );
+}
+
+void GameBoard::saveState( SnapshotWriter &out, bool packed ) const
+{
+  ZZTThing::SnapshotTable table;
+  fillSnapshotTable( table );
+
+  // fixed size parts go first, so a byte diff between two snapshots of
+  // the same board stays lined up when things come and go.
+  out.putByte( d->northExit );
+  out.putByte( d->southExit );
+  out.putByte( d->westExit );
+  out.putByte( d->eastExit );
+  out.putBool( d->darkness );
+  out.putDWord( d->boardCycle );
+  out.putInt( d->messageLife );
+  out.putByte( d->fileInfo.size() );
+  if ( !d->fileInfo.empty() ) {
+    out.putBytes( &d->fileInfo[0], d->fileInfo.size() );
+  }
+
+  d->writeField( out, table, packed );
+
+  out.putWord( table.programs.size() );
+  for ( unsigned int i = 0; i < table.programs.size(); i++ ) {
+    const ZZTOOP::ProgramBank &bank = table.programs[i]->programBank();
+    out.putWord( bank.size() );
+    if ( !bank.empty() ) {
+      out.putBytes( &bank[0], bank.size() );
+    }
+  }
+
+  // things go in list order, the player has to stay first
+  out.putWord( table.things.size() );
+  for ( unsigned int i = 0; i < table.things.size(); i++ ) {
+    out.putByte( table.things[i]->entityID() );
+  }
+  for ( unsigned int i = 0; i < table.things.size(); i++ ) {
+    table.things[i]->saveState( out, table );
+  }
+
+  out.putString( d->message );
+
+  out.putWord( d->unknownThings.size() );
+  for ( unsigned int i = 0; i < d->unknownThings.size(); i++ ) {
+    const UnknownThing &unknown = d->unknownThings[i];
+    out.putByte( unknown.id );
+    out.putWord( unknown.bytes.size() );
+    if ( !unknown.bytes.empty() ) {
+      out.putBytes( &unknown.bytes[0], unknown.bytes.size() );
+    }
+  }
+}
+
+bool GameBoard::loadState( SnapshotReader &in, bool packed )
+{
+  d->deleteContents();
+  d->revision += 1;
+
+  d->northExit = in.getByte();
+  d->southExit = in.getByte();
+  d->westExit = in.getByte();
+  d->eastExit = in.getByte();
+  d->darkness = in.getBool();
+  d->boardCycle = in.getDWord();
+  d->messageLife = in.getInt();
+  const int infoLength = in.getByte();
+  const unsigned char *info = in.getBytes( infoLength );
+  if ( info ) {
+    d->fileInfo.assign( info, info + infoLength );
+  }
+
+  // cells refer to things, so they're read once the things exist
+  const int fieldLength = packed ? in.getWord()
+                                 : FIELD_SIZE * SNAPSHOT_CELL_SIZE;
+  const unsigned char *fieldBytes = in.getBytes( fieldLength );
+
+  ZZTThing::SnapshotTable table;
+
+  const int programCount = in.getWord();
+  for ( int i = 0; i < programCount && in.ok(); i++ ) {
+    const int length = in.getWord();
+    const unsigned char *bytes = in.getBytes( length );
+    ZZTOOP::Interpreter *interp = new ZZTOOP::Interpreter;
+    if ( bytes && length > 0 ) {
+      interp->setProgram( bytes, length );
+    }
+    addInterpreter( interp );
+    table.programs.push_back( interp );
+  }
+
+  // create every thing first, so that they can refer to each other
+  ThingFactory factory;
+  factory.setWorld( d->world );
+  factory.setBoard( this );
+
+  const int thingCount = in.getWord();
+  for ( int i = 0; i < thingCount && in.ok(); i++ ) {
+    ZZTThing::AbstractThing *thing = factory.createEmptyThing( in.getByte() );
+    if ( !thing ) {
+      in.fail();
+      break;
+    }
+    d->thingList.push_back( thing );
+    table.things.push_back( thing );
+  }
+
+  for ( unsigned int i = 0; i < table.things.size() && in.ok(); i++ ) {
+    table.things[i]->loadState( in, table );
+  }
+
+  d->message = in.getString();
+
+  d->unknownThings.clear();
+  const int unknownCount = in.getWord();
+  for ( int i = 0; i < unknownCount && in.ok(); i++ ) {
+    const unsigned char id = in.getByte();
+    const int length = in.getWord();
+    const unsigned char *bytes = in.getBytes( length );
+    // the loader only keeps whole things, anything shorter is damage
+    if ( length < ThingHeader::size ) {
+      in.fail();
+    }
+    else if ( bytes ) {
+      addUnknownThing( id, bytes, length );
+    }
+  }
+
+  if ( fieldBytes && !d->readField( fieldBytes, fieldLength, table, packed ) ) {
+    in.fail();
+  }
+
+  if ( !in.ok() || table.things.empty() ||
+       table.things.front()->entityID() != ZZTEntity::Player )
+  {
+    zwarn() << "GameBoard::loadState failed";
+    d->deleteContents();
+    d->unknownThings.clear();
+    for ( int i = 0; i < FIELD_SIZE; i++ ) {
+      d->field[i] = ZZTEntity();
+    }
+    return false;
+  }
+
+  return true;
+}
@@ -8,15 +8,22 @@
 #ifndef GAME_BOARD_H
 #define GAME_BOARD_H
 
+#include <vector>
+
 class GameWorld;
 class AbstractPainter;
 class ZZTEntity;
+class ZStringView;
 class AbstractMusicStream;
+class SnapshotWriter;
+class SnapshotReader;
+class ScriptStats;
 
 namespace ZZTThing {
   class AbstractThing;
   class Player;
   class ProgramBank;
+  class SnapshotTable;
 }
 
 namespace ZZTOOP {
@@ -25,6 +32,16 @@ namespace ZZTOOP {
 
 class GameBoardPrivate;
 
+/// a thing from the world file the engine has no class for, like bombs
+/// and conveyors. Kept as it was so the writer can put it back.
+struct UnknownThing
+{
+  /// the entity it was attached to
+  unsigned char id;
+  /// header and program, as they were in the file
+  std::vector<unsigned char> bytes;
+};
+
 /// A single board in a zzt world
 class GameBoard
 {
@@ -54,6 +71,9 @@ class GameBoard
     const ZZTEntity & entity( int x, int y ) const;
     /// adds an entity to the 60x25 grid
     void setEntity( int x, int y, const ZZTEntity &entity );
+    /// copies one entity into count cells, reading order from the top left.
+    /// For the world loader, the span is clipped to the grid.
+    void fillEntities( int index, int count, const ZZTEntity &entity );
     /// replaces an entity, deletes associated Thing.
     void replaceEntity( int x, int y, const ZZTEntity &newEntity );
     /// resets an entity to EmptySpace, deletes associated Thing.
@@ -63,6 +83,13 @@ class GameBoard
     const ZString &message() const;
     /// changes the currently flashing message
     void setMessage( const ZString &mesg );
+    /// cycles left before the message stops flashing
+    int messageLife() const;
+
+    /// accessor
+    const ZString &title() const;
+    /// sets the board title, as shown on passages and in the editor
+    void setTitle( const ZString &title );
 
     /// adds a object that will interact with the board
     void addThing( ZZTThing::AbstractThing *thing );
@@ -83,7 +110,7 @@ class GameBoard
     void deleteThing( ZZTThing::AbstractThing *thing );
 
     /// sends a message to all appropriately named objects
-    void sendLabel( const ZString &to, const ZString &label,
+    void sendLabel( const ZStringView &to, const ZStringView &label,
                     const ZZTThing::AbstractThing *from );
 
     /// Returns the player for the board. Every board must have one.
@@ -112,6 +139,17 @@ class GameBoard
     /// set to the eastern exit
     void setEastExit( int exit );
 
+    /// keeps the board information block from the world file, so the
+    /// parts the engine doesn't use can be written back out
+    void setFileInfo( const unsigned char *data, int length );
+    /// empty for boards that didn't come from a world file
+    const std::vector<unsigned char> &fileInfo() const;
+
+    /// keeps a thing from the world file that the loader couldn't make
+    void addUnknownThing( unsigned char id, const unsigned char *data, int length );
+    /// accessor
+    const std::vector<UnknownThing> &unknownThings() const;
+
     /// accessor to the board cycle for Thing timing
     unsigned int cycle() const;
 
@@ -121,6 +159,23 @@ class GameBoard
     /// search for a given entity, only lower nibble considered.
     bool isAnyEntity( unsigned char id, unsigned char color = 0xFF ) const;
 
+    /// bumped whenever anything on the board may have changed
+    unsigned int revision() const;
+
+    /// ZZT-OOP counters for every object that has run on the board
+    const ScriptStats &scriptStats() const;
+    /// adds to the board's ZZT-OOP counters
+    void addScriptStats( const ScriptStats &stats );
+
+    /// the board's things, player first, and the programs they run
+    void fillSnapshotTable( ZZTThing::SnapshotTable &table ) const;
+
+    /// writes the board, its things and programs to a snapshot. Packed
+    /// run-length codes the field, smaller but no good for diffing.
+    void saveState( SnapshotWriter &out, bool packed = false ) const;
+    /// replaces the board with what saveState wrote. false on bad data.
+    bool loadState( SnapshotReader &in, bool packed = false );
+
   private:
     GameBoardPrivate *d;
 };
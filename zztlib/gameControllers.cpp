@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <ctime>
 
 #include "debug.h"
 #include "zstring.h"
@@ -25,6 +26,10 @@
 #include "gameWorld.h"
 #include "scrollView.h"
 #include "worldLoader.h"
+#include "worldSnapshot.h"
+#include "rewindBuffer.h"
+#include "replay.h"
+#include "frameStats.h"
 
 #include "gameControllers.h"
 
@@ -52,17 +57,11 @@ void ControllerInterface::leave()
   manager = 0;
   share = 0;
 
-  // would delete self if ::create instances weren't statics.
+  // instances belong to the ControllerShare, nothing to delete.
 }
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface * PlayController::create()
-{
-  static PlayController instance;
-  return &instance;
-}
-
 void PlayController::doKeypress( int keycode, int unicode )
 {
   bool filtered = false;
@@ -71,7 +70,7 @@ void PlayController::doKeypress( int keycode, int unicode )
       switch ( unicode ) {
         case 'P':
         case 'p':
-          share->nextController = PauseController::create();
+          share->nextController = &share->pauseController;
           filtered = true;
           break;
 
@@ -84,7 +83,7 @@ void PlayController::doKeypress( int keycode, int unicode )
         }
 
         case '?':
-          share->nextController = CheatController::create();
+          share->nextController = &share->cheatController;
           filtered = true;
           break;
 
@@ -92,8 +91,56 @@ void PlayController::doKeypress( int keycode, int unicode )
       }
       break;
 
+    case Z_Tab: {
+      const bool turbo = ( share->world->turbo() > 1 );
+      share->world->setTurbo( turbo ? 1 : share->turboFactor );
+      filtered = true;
+      break;
+    }
+
+    case Z_F3:
+      share->showScriptProfile = !share->showScriptProfile;
+      share->world->setScriptClock( share->showScriptProfile ? share->clock : 0 );
+      share->dirty = true;
+      filtered = true;
+      break;
+
+    case Z_F2:
+      share->showFrameStats = !share->showFrameStats;
+      share->frameStats.setEnabled( share->showFrameStats ||
+                                    !share->frameStatsFile.empty() );
+      share->playModeInfoBarWidget.setFrameStats( share->showFrameStats ? &share->frameStats : 0 );
+      share->dirty = true;
+      filtered = true;
+      break;
+
+    case Z_F5:
+      share->world->saveSnapshot( share->quickSave );
+      share->world->currentBoard()->setMessage( "Quick saved" );
+      filtered = true;
+      break;
+
+    case Z_F9:
+      // a replay can't follow the world jumping around
+      if ( !share->replayRecorder.isRecording() &&
+           !share->quickSave.isNull() &&
+           share->world->restoreSnapshot( share->quickSave ) ) {
+        share->world->currentBoard()->setMessage( "Quick loaded" );
+        share->dirty = true;
+      }
+      filtered = true;
+      break;
+
+    case Z_Backspace:
+      if ( !share->replayRecorder.isRecording() &&
+           share->rewindBuffer.stepBack( share->world ) ) {
+        share->dirty = true;
+      }
+      filtered = true;
+      break;
+
     case Z_Escape:
-      share->nextController = TitleController::create();
+      share->nextController = &share->titleController;
       filtered = true;
       break;
 
@@ -107,12 +154,14 @@ void PlayController::doKeypress( int keycode, int unicode )
 
 void PlayController::doUpdate()
 {
-  share->world->update();
+  if ( share->world->update() || share->showFrameStats ) {
+    share->dirty = true;
+  }
   if ( share->scrollView.model() ) {
-    share->nextController = TextViewController::create();
+    share->nextController = &share->textViewController;
   }
   else if ( share->world->isChangingBoard() ) {
-    share->nextController = TransitionController::create();
+    share->nextController = &share->transitionController;
     share->transitionNextBoard = share->world->changingIndex();
   }
 }
@@ -121,18 +170,36 @@ void PlayController::doPaint( AbstractPainter *painter )
 {
   share->world->paint( painter );
   share->playModeInfoBarWidget.doPaint( painter );
+  if ( share->showScriptProfile ) {
+    share->scriptProfileWidget.doPaint( painter );
+  }
 }
 
-// ---------------------------------------------------------------------------
+void PlayController::enter_impl()
+{
+  if ( !share->replayFile.empty() && !share->replayRecorder.isRecording() ) {
+    share->replayRecorder.begin( share->world, time(0) );
+  }
+}
 
-ControllerInterface * TitleController::create()
+void PlayController::leave_impl()
 {
-  static TitleController instance;
-  return &instance;
+  // pauses and scrolls come back to the same game, the title screen doesn't
+  if ( share->nextController == &share->titleController ) {
+    share->world->setTurbo( 1 );
+  }
 }
 
+// ---------------------------------------------------------------------------
+
 void TitleController::enter_impl()
 {
+  if ( share->replayRecorder.isRecording() ) {
+    // only the one session gets recorded
+    share->replayRecorder.end( share->replayFile );
+    share->replayFile.clear();
+  }
+
   GameBoard *board = share->world->getBoard( 0 );
   share->world->setCurrentBoard( board );
 }
@@ -144,16 +211,16 @@ void TitleController::doKeypress( int keycode, int unicode )
       switch ( unicode ) {
         case 'P':
         case 'p':
-          share->nextController = TransitionController::create();
+          share->nextController = &share->transitionController;
           share->transitionNextBoard = share->world->startBoard();
           break;
         case 'S':
         case 's':
-          share->nextController = PickSpeedController::create();
+          share->nextController = &share->pickSpeedController;
           break;
         case 'W':
         case 'w':
-          share->nextController = WorldMenuController::create();
+          share->nextController = &share->worldMenuController;
           break;
         default: break;
       } break;
@@ -165,7 +232,9 @@ void TitleController::doKeypress( int keycode, int unicode )
 
 void TitleController::doUpdate()
 {
-  share->world->update();
+  if ( share->world->update() ) {
+    share->dirty = true;
+  }
 }
 
 void TitleController::doPaint( AbstractPainter *painter )
@@ -176,12 +245,6 @@ void TitleController::doPaint( AbstractPainter *painter )
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface * WorldMenuController::create()
-{
-  static WorldMenuController instance;
-  return &instance;
-}
-
 void WorldMenuController::doKeypress( int keycode, int unicode )
 {
   share->scrollView.doKeypress( keycode, unicode );
@@ -189,7 +252,13 @@ void WorldMenuController::doKeypress( int keycode, int unicode )
 
 void WorldMenuController::doUpdate()
 {
-  share->scrollView.update();
+  if ( !share->scrollView.isOpened() ) {
+    share->dirty = true;
+  }
+  if ( share->scrollView.update() ) {
+    // a directory finished scanning
+    share->dirty = true;
+  }
 
   if ( !share->scrollView.isClosed() ) return;
 
@@ -212,12 +281,12 @@ void WorldMenuController::doUpdate()
         manager->setWorld( GameWorld::createEmptyWorld() );
       }
       delete old;
-      share->nextController = TitleController::create();
+      share->nextController = &share->titleController;
       break;
     }
 
     default:
-      share->nextController = TitleController::create();
+      share->nextController = &share->titleController;
       break;
   }
 }
@@ -243,12 +312,6 @@ void WorldMenuController::leave_impl()
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface * TextViewController::create()
-{
-  static TextViewController instance;
-  return &instance;
-}
-
 void TextViewController::doKeypress( int keycode, int unicode )
 {
   share->scrollView.doKeypress( keycode, unicode );
@@ -256,6 +319,9 @@ void TextViewController::doKeypress( int keycode, int unicode )
 
 void TextViewController::doUpdate()
 {
+  if ( !share->scrollView.isOpened() ) {
+    share->dirty = true;
+  }
   share->scrollView.update();
 
   if ( !share->scrollView.isClosed() ) return;
@@ -263,7 +329,7 @@ void TextViewController::doUpdate()
   switch ( share->scrollView.action() )
   {
     default:
-      share->nextController = PlayController::create();
+      share->nextController = &share->playController;
       break;
   }
 }
@@ -288,17 +354,11 @@ void TextViewController::leave_impl()
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface * CheatController::create()
-{
-  static CheatController instance;
-  return &instance;
-}
-
 void CheatController::doKeypress( int keycode, int unicode )
 {
   switch ( keycode ) {
     case Z_Enter:
-      share->nextController = PlayController::create();
+      share->nextController = &share->playController;
       break;
     default:
       share->textInputWidget.doKeypress(keycode, unicode);
@@ -325,23 +385,17 @@ void CheatController::leave_impl()
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface * PickSpeedController::create()
-{
-  static PickSpeedController instance;
-  return &instance;
-}
-
 void PickSpeedController::doKeypress( int keycode, int unicode )
 {
   switch ( keycode ) {
     case Z_Enter:
-      share->nextController = TitleController::create();
+      share->nextController = &share->titleController;
       break;
     case Z_Unicode:
       switch ( unicode ) {
         case 'S':
         case 's':
-          share->nextController = TitleController::create();
+          share->nextController = &share->titleController;
           break;
       }
       break;
@@ -370,12 +424,6 @@ void PickSpeedController::leave_impl()
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface *PauseController::create()
-{
-  static PauseController instance;
-  return &instance;
-}
-
 void PauseController::doKeypress( int keycode, int unicode )
 {
   switch ( keycode ) {
@@ -383,11 +431,20 @@ void PauseController::doKeypress( int keycode, int unicode )
       switch ( unicode ) {
         case 'P':
         case 'p':
-          share->nextController = PlayController::create();
+          share->nextController = &share->playController;
           break;
         default: break;
       }
       break;
+
+    case Z_Backspace:
+      // step back one cycle at a time while paused
+      if ( !share->replayRecorder.isRecording() &&
+           share->rewindBuffer.stepBack( share->world ) ) {
+        share->dirty = true;
+      }
+      break;
+
     default: break;
   }
 }
@@ -409,12 +466,6 @@ void PauseController::leave_impl()
 
 // ---------------------------------------------------------------------------
 
-ControllerInterface *TransitionController::create()
-{
-  static TransitionController instance;
-  return &instance;
-}
-
 static void updateStrangeBorderTransitionClear( GameWorld *world )
 {
   for( int i = 0; i < 60; i++ ) {
@@ -429,6 +480,8 @@ static void updateStrangeBorderTransitionClear( GameWorld *world )
 
 void TransitionController::doUpdate()
 {
+  share->dirty = true;
+
   const int transitionSpeed = 120;
   int nextStep = clock + transitionSpeed;
   if ( nextStep >= 1500 ) nextStep = 1500;
@@ -450,7 +503,7 @@ void TransitionController::doUpdate()
       updateStrangeBorderTransitionClear( share->world );
     }
     else {
-      share->nextController = PlayController::create();
+      share->nextController = &share->playController;
     }
   }
 }
@@ -475,8 +528,13 @@ ControllerShare::ControllerShare()
    world(0),
    fileModelFactory(0),
    musicStream(0),
+   showScriptProfile(false),
+   clock(0),
+   showFrameStats(false),
    transitionNextBoard(0),
-   quitting(false)
+   turboFactor(20),
+   quitting(false),
+   dirty(true)
 {
   transitionList.reserve(1500);
   for ( int i = 0; i < 1500; i++ ) {
@@ -12,9 +12,12 @@
 
 class AbstractFileModelFactory;
 class AbstractMusicStream;
+class AbstractClock;
 class ControllerShare;
+class FrameStats;
 class FreeZZTManager;
 class PlayModeInfoBarWidget;
+class ScriptProfileWidget;
 class ScrollView;
 class TextInputWidget;
 class TitleModeInfoBarWidget;
@@ -47,11 +50,12 @@ class ControllerInterface
 class PlayController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doUpdate();
     virtual void doPaint( AbstractPainter *painter );
+  protected:
+    virtual void enter_impl();
+    virtual void leave_impl();
 };
 
 // ---------------------------------------------------------------------------
@@ -59,8 +63,6 @@ class PlayController: public ControllerInterface
 class TitleController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doUpdate();
     virtual void doPaint( AbstractPainter *painter );
@@ -73,8 +75,6 @@ class TitleController: public ControllerInterface
 class WorldMenuController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doUpdate();
     virtual void doPaint( AbstractPainter *painter );
@@ -88,8 +88,6 @@ class WorldMenuController: public ControllerInterface
 class TextViewController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doUpdate();
     virtual void doPaint( AbstractPainter *painter );
@@ -103,8 +101,6 @@ class TextViewController: public ControllerInterface
 class CheatController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doPaint( AbstractPainter *painter );
   protected:
@@ -117,8 +113,6 @@ class CheatController: public ControllerInterface
 class PickSpeedController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doPaint( AbstractPainter *painter );
   protected:
@@ -131,8 +125,6 @@ class PickSpeedController: public ControllerInterface
 class PauseController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doKeypress( int keycode, int unicode );
     virtual void doPaint( AbstractPainter *painter );
   protected:
@@ -145,8 +137,6 @@ class PauseController: public ControllerInterface
 class TransitionController: public ControllerInterface
 {
   public:
-    static ControllerInterface *create();
-
     virtual void doUpdate();
     virtual void doPaint( AbstractPainter *painter );
   protected:
@@ -166,16 +156,45 @@ class ControllerShare
     ControllerInterface *currentController;
     ControllerInterface *nextController;
 
+    /// one of each per manager, so several can run side by side
+    PlayController playController;
+    TitleController titleController;
+    WorldMenuController worldMenuController;
+    TextViewController textViewController;
+    CheatController cheatController;
+    PickSpeedController pickSpeedController;
+    PauseController pauseController;
+    TransitionController transitionController;
+
     GameWorld *world;
     AbstractFileModelFactory *fileModelFactory;
     AbstractMusicStream *musicStream;
     TitleModeInfoBarWidget titleModeInfoBarWidget;
     PlayModeInfoBarWidget playModeInfoBarWidget;
+    /// F3 in play mode, the clock only runs while it's shown
+    ScriptProfileWidget scriptProfileWidget;
+    bool showScriptProfile;
+    AbstractClock *clock;
+    /// F2 in play mode shows these on the sidebar
+    FrameStats frameStats;
+    bool showFrameStats;
+    /// written on exit when set, timings get taken the whole session
+    ZString frameStatsFile;
     TextInputWidget textInputWidget;
     ScrollView scrollView;
     std::vector<int> transitionList;
     int transitionNextBoard;
+    int turboFactor;
+    /// F5 and F9 in play mode
+    WorldSnapshot quickSave;
+    /// Backspace in play and pause modes
+    RewindBuffer rewindBuffer;
+    /// records the first play session into replayFile, if one's set
+    ReplayRecorder replayRecorder;
+    ZString replayFile;
     bool quitting;
+    /// something on screen changed since the last paint
+    bool dirty;
 };
 
 #endif
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 
 #include "debug.h"
 #include "defines.h"
@@ -14,6 +15,10 @@
 #include "abstractPainter.h"
 #include "abstractMusicStream.h"
 #include "gameWorld.h"
+#include "gameBoard.h"
+#include "zztEntity.h"
+#include "scriptable.h"
+#include "frameStats.h"
 #include "gameWidgets.h"
 
 using namespace Defines;
@@ -27,6 +32,7 @@ static const int buttonColor = BG_GRAY | BLACK;
 static const int altColor = BG_CYAN | BLACK;
 static const int ammoColor = BG_BLUE | CYAN;
 static const int torchColor = BG_BLUE | DARK_BROWN;
+static const int profileColor = GRAY;
 
 // -----------------------------------------------------------------
 
@@ -352,6 +358,7 @@ void TitleModeInfoBarWidget::doPaint( AbstractPainter *painter )
 // -----------------------------------------------------------------
 
 PlayModeInfoBarWidget::PlayModeInfoBarWidget()
+  : m_frameStats(0)
 {
   setRow(0);
   setColumn(60);
@@ -375,29 +382,126 @@ void PlayModeInfoBarWidget::doPaint( AbstractPainter *painter )
   drawItemLine( painter, x,11, 0x20, textColor,  "   Score:", textColor, world()->currentScore() );
   drawKeysLine( painter, x,12, 0x0c, textColor,  "    Keys:", textColor, world() );
   drawCenteredTextLine( painter, x, 13, " ", textColor, textColor );
-  drawButtonLine( painter, x, 14, "T", buttonColor, "Torch", textColor );
 
-  if ( world()->musicStream()->isQuiet() ) {
-    drawButtonLine( painter, x, 15, "B", altColor,    "Be noisy", textColor );
+  if ( m_frameStats ) {
+    drawFrameStats( painter, x, 14 );
   }
   else {
-    drawButtonLine( painter, x, 15, "B", altColor,    "Be quiet", textColor );
+    drawButtonLine( painter, x, 14, "T", buttonColor, "Torch", textColor );
+
+    if ( world()->musicStream()->isQuiet() ) {
+      drawButtonLine( painter, x, 15, "B", altColor,    "Be noisy", textColor );
+    }
+    else {
+      drawButtonLine( painter, x, 15, "B", altColor,    "Be quiet", textColor );
+    }
+    drawButtonLine( painter, x, 16, "H", buttonColor, "Help", textColor );
+    drawCenteredTextLine( painter, x, 17, " ", textColor, textColor );
+    ZString arrows;
+    arrows.append( 1, 0x18 );
+    arrows.append( 1, 0x19 );
+    arrows.append( 1, 0x1a );
+    arrows.append( 1, 0x1b );
+    drawButtonLine( painter, x, 18, arrows, altColor, "Move", textColor );
+    ZString shiftArrows = "Shift";
+    shiftArrows.append(arrows);
+    drawButtonLine( painter, x, 19, shiftArrows, buttonColor, "Shoot", textColor );
+    drawCenteredTextLine( painter, x, 20, " ", textColor, textColor );
   }
-  drawButtonLine( painter, x, 16, "H", buttonColor, "Help", textColor );
-  drawCenteredTextLine( painter, x, 17, " ", textColor, textColor );
-  ZString arrows;
-  arrows.append( 1, 0x18 );
-  arrows.append( 1, 0x19 );
-  arrows.append( 1, 0x1a );
-  arrows.append( 1, 0x1b );
-  drawButtonLine( painter, x, 18, arrows, altColor, "Move", textColor );
-  ZString shiftArrows = "Shift";
-  shiftArrows.append(arrows);
-  drawButtonLine( painter, x, 19, shiftArrows, buttonColor, "Shoot", textColor );
-  drawCenteredTextLine( painter, x, 20, " ", textColor, textColor );
+
   drawButtonLine( painter, x, 21, "S", buttonColor, "Save game", textColor );
   drawButtonLine( painter, x, 22, "P", altColor,    "Pause", textColor );
   drawButtonLine( painter, x, 23, "Q", buttonColor, "Quit", textColor );
   drawCenteredTextLine( painter, x, 24, " ", textColor, textColor );
 }
 
+void PlayModeInfoBarWidget::drawFrameStats( AbstractPainter *painter,
+                                            int column, int row )
+{
+  // microseconds, over the latest frames
+  painter->drawText( column, row, textColor, "  Phase    p50   p99" );
+  for ( int p = 0; p < FrameStats::PHASE_COUNT; p++ ) {
+    const FrameStats::Phase phase = (FrameStats::Phase) p;
+    const int y = row + 1 + p;
+    painter->drawText( column, y, textColor, "        " );
+    painter->drawText( column+2, y, altTextColor, FrameStats::phaseName( phase ) );
+    painter->drawNumber( column+8, y, textColor, m_frameStats->percentile( phase, 50 ),
+                         6, AbstractPainter::RIGHT );
+    painter->drawNumber( column+14, y, textColor, m_frameStats->percentile( phase, 99 ),
+                         6, AbstractPainter::RIGHT );
+  }
+}
+
+// -----------------------------------------------------------------
+
+static const int profileRows = 10;
+
+static bool busierScript( const ZZTThing::ScriptableThing *a,
+                          const ZZTThing::ScriptableThing *b )
+{
+  const ScriptStats &sa = a->lastRunStats();
+  const ScriptStats &sb = b->lastRunStats();
+  if ( sa.micros != sb.micros ) return sa.micros > sb.micros;
+  return sa.instructions > sb.instructions;
+}
+
+static void drawProfileLine( AbstractPainter *painter, int row,
+                             const ZString &name, int x, int y,
+                             const ScriptStats &last,
+                             const ScriptStats &total )
+{
+  painter->drawText( 0, row, profileColor, "            " );
+  painter->drawText( 0, row, profileColor, name.substr( 0, 12 ) );
+  painter->drawNumber( 12, row, profileColor, x, 3, AbstractPainter::RIGHT );
+  painter->drawNumber( 15, row, profileColor, y, 3, AbstractPainter::RIGHT );
+  painter->drawNumber( 18, row, profileColor, last.instructions, 6, AbstractPainter::RIGHT );
+  painter->drawNumber( 24, row, profileColor, last.freebies, 6, AbstractPainter::RIGHT );
+  painter->drawNumber( 30, row, profileColor, last.micros, 7, AbstractPainter::RIGHT );
+  painter->drawNumber( 37, row, profileColor, total.instructions, 9, AbstractPainter::RIGHT );
+  painter->drawNumber( 46, row, profileColor, total.messagesSent, 7, AbstractPainter::RIGHT );
+  painter->drawNumber( 53, row, profileColor, total.labelsSought, 7, AbstractPainter::RIGHT );
+}
+
+ScriptProfileWidget::ScriptProfileWidget()
+{
+  setRow(0);
+  setColumn(0);
+}
+
+void ScriptProfileWidget::doPaint( AbstractPainter *painter )
+{
+  GameBoard *board = world()->currentBoard();
+  if ( !board ) return;
+
+  std::vector<ZZTThing::ScriptableThing*> scripts;
+  for ( int y = 0; y < 25; y++ ) {
+    for ( int x = 0; x < 60; x++ ) {
+      ZZTThing::ScriptableThing *script =
+        dynamic_cast<ZZTThing::ScriptableThing*>( board->entity(x, y).thing() );
+      if ( script ) scripts.push_back( script );
+    }
+  }
+  std::sort( scripts.begin(), scripts.end(), busierScript );
+
+  int line = row();
+  painter->drawText( 0, line, textColor,
+    "Object        X  Y Lines  Free   usec    Total   Sent  Seeks" );
+  line += 1;
+
+  const int shown = std::min( (int) scripts.size(), profileRows );
+  for ( int i = 0; i < shown; i++, line++ ) {
+    const ZZTThing::ScriptableThing *script = scripts[i];
+    drawProfileLine( painter, line, script->objectName(),
+                     script->xPos(), script->yPos(),
+                     script->lastRunStats(), script->totalStats() );
+  }
+
+  // everything run on this board since it was loaded
+  const ScriptStats &total = board->scriptStats();
+  painter->drawText( 0, line, textColor, "Board scripts" );
+  painter->drawNumber( 13, line, textColor, scripts.size(), 4, AbstractPainter::RIGHT );
+  painter->drawText( 17, line, textColor, "                    " );
+  painter->drawNumber( 37, line, textColor, total.instructions, 9, AbstractPainter::RIGHT );
+  painter->drawNumber( 46, line, textColor, total.messagesSent, 7, AbstractPainter::RIGHT );
+  painter->drawNumber( 53, line, textColor, total.labelsSought, 7, AbstractPainter::RIGHT );
+}
@@ -9,6 +9,7 @@
 #define __GAME_WIDGETS_H__
 
 class AbstractPainter;
+class FrameStats;
 class GameWorld;
 
 class GameWidget
@@ -141,6 +142,26 @@ class PlayModeInfoBarWidget : public GameWorldAwareWidget
   public:
     PlayModeInfoBarWidget();
     virtual void doPaint( AbstractPainter *painter );
+
+    /// F2 in play mode, frame timings replace the key help. 0 hides them.
+    void setFrameStats( const FrameStats *stats ) { m_frameStats = stats; };
+    const FrameStats *frameStats() const { return m_frameStats; };
+
+  private:
+    void drawFrameStats( AbstractPainter *painter, int column, int row );
+
+  private:
+    const FrameStats *m_frameStats;
+};
+
+// -----------------------------------------------------------------
+
+/// F3 in play mode, the busiest scripts on the board
+class ScriptProfileWidget : public GameWorldAwareWidget
+{
+  public:
+    ScriptProfileWidget();
+    virtual void doPaint( AbstractPainter *painter );
 };
 
 #endif /* __GAME_WIDGETS_H__ */
@@ -6,13 +6,16 @@
  */
 
 #include <string>
-#include <set>
+#include <vector>
+#include <algorithm>
 #include <map>
 #include <list>
 #include <sstream>
 
 #include "debug.h"
 #include "zstring.h"
+#include "zstringView.h"
+#include "symbolTable.h"
 #include "defines.h"
 #include "scrollView.h"
 #include "gameWorld.h"
@@ -20,10 +23,46 @@
 #include "abstractPainter.h"
 #include "abstractMusicStream.h"
 #include "player.h"
+#include "randomizer.h"
+#include "snapshotStream.h"
+#include "worldSnapshot.h"
+#include "rewindBuffer.h"
+#include "replay.h"
+#include "frameStats.h"
 
 enum { BOARD_SWITCH_NONE = -1 };
 typedef std::map<int, GameBoard*> GameBoardMap;
 
+/// the blob a board was last saved to or restored from
+struct SyncedBoard
+{
+  SnapshotBlob blob;
+  unsigned int revision;
+};
+typedef std::map<int, SyncedBoard> SyncedBoardMap;
+
+/// the world's part of a snapshot, read out on the side so nothing gets
+/// touched until the whole snapshot has checked out
+struct WorldState
+{
+  int startBoard;
+  int currentAmmo;
+  int currentGems;
+  int currentHealth;
+  int currentTorches;
+  int currentTorchCycles;
+  int currentScore;
+  int currentEnergizerCycles;
+  int currentTimePassed;
+  bool doorKeys[ GameWorld::max_doorkey ];
+  ZString worldTitle;
+  std::vector<ZString> gameFlags;
+  int currentIndex;
+  int boardSwitch;
+  int cycleCountdown;
+  unsigned int randomState;
+};
+
 // ---------------------------------------------------------------------------
 
 class GameWorldPrivate
@@ -32,6 +71,12 @@ class GameWorldPrivate
     GameWorldPrivate( GameWorld *pSelf );
     virtual ~GameWorldPrivate();
 
+    void execCycle();
+
+    void saveState( SnapshotWriter &out ) const;
+    static bool readState( SnapshotReader &in, WorldState &state );
+    void applyState( const WorldState &state );
+
     int startBoard;
     int currentAmmo;
     int currentGems;
@@ -55,7 +100,9 @@ class GameWorldPrivate
     bool pressed_torch;
 
     ZString worldTitle;
-    std::set<ZString> gameFlags;
+    SymbolTable symbols;
+    /// symbols, in the slots a world file would keep them in
+    std::vector<int> gameFlags;
 
     GameBoardMap boards;
     int maxBoards;
@@ -65,12 +112,21 @@ class GameWorldPrivate
 
     int cycleCountdown;
     int cycleSetting;
+    int turboFactor;
 
     int transitionCount;
     bool *transitionTiles;
 
     AbstractMusicStream *musicStream;
     ScrollView *scrollView;
+    RewindBuffer *rewindBuffer;
+    ReplayRecorder *replayRecorder;
+    Randomizer randomizer;
+    AbstractClock *scriptClock;
+    FrameStats *frameStats;
+    int scriptErrors;
+
+    SyncedBoardMap syncedBoards;
 
   private:
     GameWorld *self;
@@ -100,9 +156,16 @@ GameWorldPrivate::GameWorldPrivate( GameWorld *pSelf )
     boardSwitch( BOARD_SWITCH_NONE ),
     cycleCountdown( 0 ),
     cycleSetting( 4 ),
+    turboFactor( 1 ),
     transitionCount( 0 ),
     transitionTiles( 0 ),
     musicStream( 0 ),
+    scrollView( 0 ),
+    rewindBuffer( 0 ),
+    replayRecorder( 0 ),
+    scriptClock( 0 ),
+    frameStats( 0 ),
+    scriptErrors( 0 ),
     self(pSelf)
 {
   for ( int x = GameWorld::BLUE_DOORKEY; x < GameWorld::max_doorkey; x++ ) {
@@ -282,21 +345,48 @@ const ZString &GameWorld::worldTitle() const
   return d->worldTitle;
 }
 
-void GameWorld::addGameFlag( const ZString &flag )
+void GameWorld::addGameFlag( const ZStringView &flag )
 {
   if ( d->gameFlags.size() >= 10 ) return;
 
-  d->gameFlags.insert( flag );
+  const int symbol = d->symbols.intern( flag );
+  if ( std::find( d->gameFlags.begin(), d->gameFlags.end(), symbol )
+       == d->gameFlags.end() ) {
+    d->gameFlags.push_back( symbol );
+  }
+}
+
+void GameWorld::removeGameFlag( const ZStringView &flag )
+{
+  // a flag that was never interned can't be set
+  const int symbol = d->symbols.find( flag );
+  if ( symbol == SymbolTable::None ) return;
+
+  std::vector<int>::iterator iter =
+    std::find( d->gameFlags.begin(), d->gameFlags.end(), symbol );
+  if ( iter != d->gameFlags.end() ) {
+    d->gameFlags.erase( iter );
+  }
+}
+
+bool GameWorld::hasGameFlag( const ZStringView &flag )
+{
+  const int symbol = d->symbols.find( flag );
+  if ( symbol == SymbolTable::None ) return false;
+
+  return std::find( d->gameFlags.begin(), d->gameFlags.end(), symbol )
+         != d->gameFlags.end();
 }
 
-void GameWorld::removeGameFlag( const ZString &flag )
+int GameWorld::gameFlagCount() const
 {
-  d->gameFlags.erase( flag );
+  return d->gameFlags.size();
 }
 
-bool GameWorld::hasGameFlag( const ZString &flag )
+ZString GameWorld::gameFlag( int index ) const
 {
-  return d->gameFlags.count( flag ) != 0;
+  if ( index < 0 || index >= (int) d->gameFlags.size() ) return ZString();
+  return d->symbols.name( d->gameFlags[index] );
 }
 
 void GameWorld::addBoard( int index, GameBoard *board )
@@ -351,43 +441,74 @@ GameBoard * GameWorld::currentBoard() const
   return d->currentBoard;
 }
 
-void GameWorld::update()
+bool GameWorld::update()
 {
+  if ( d->turboFactor > 1 ) {
+    // skip the frame delay and run a batch of cycles as one, timed as
+    // one too since it's all this frame's exec
+    PhaseTimer timer( d->frameStats, FrameStats::WorldExecPhase );
+    d->musicStream->begin();
+    for ( int i = 0; i < d->turboFactor; i++ ) {
+      d->execCycle();
+      // stop early for anything the controllers need to see
+      if ( isChangingBoard() ) break;
+      if ( d->scrollView && d->scrollView->model() ) break;
+    }
+    d->musicStream->end();
+    return true;
+  }
+
   if ( d->cycleCountdown > 0 ) {
     d->cycleCountdown -= 1;
+    return false;
   }
-  else {
-    d->cycleCountdown = d->cycleSetting;
-    exec();
-  }
+
+  d->cycleCountdown = d->cycleSetting;
+  exec();
+  return true;
 }
 
 void GameWorld::exec()
 {
+  PhaseTimer timer( d->frameStats, FrameStats::WorldExecPhase );
   d->musicStream->begin();
-  if ( d->boardSwitch != BOARD_SWITCH_NONE ) {
-    setCurrentBoard( getBoard(d->boardSwitch) );
-    d->boardSwitch = BOARD_SWITCH_NONE;
+  d->execCycle();
+  d->musicStream->end();
+}
+
+void GameWorldPrivate::execCycle()
+{
+  if ( boardSwitch != BOARD_SWITCH_NONE ) {
+    self->setCurrentBoard( self->getBoard(boardSwitch) );
+    boardSwitch = BOARD_SWITCH_NONE;
   }
 
-  if (d->currentTorchCycles > 0) {
-    d->currentTorchCycles -= 1;
+  if (currentTorchCycles > 0) {
+    currentTorchCycles -= 1;
   }
 
-  if ( d->pressed_torch &&
-       d->currentTorchCycles == 0 &&
-       d->currentTorches > 0 ) {
-    d->currentTorches -= 1;
-    d->currentTorchCycles = 1000;
+  if ( pressed_torch &&
+       currentTorchCycles == 0 &&
+       currentTorches > 0 ) {
+    currentTorches -= 1;
+    currentTorchCycles = 1000;
   }
 
-  if (d->currentEnergizerCycles > 0) {
-    d->currentTorchCycles -= 1;
+  if (currentEnergizerCycles > 0) {
+    currentTorchCycles -= 1;
   }
 
-  currentBoard()->exec();
-  clearInputKeys();
-  d->musicStream->end();
+  currentBoard->exec();
+
+  if ( replayRecorder ) {
+    replayRecorder->endCycle();
+  }
+
+  self->clearInputKeys();
+
+  if ( rewindBuffer ) {
+    rewindBuffer->record( self );
+  }
 }
 
 void GameWorld::paint( AbstractPainter *painter )
@@ -439,6 +560,11 @@ bool GameWorld::transitionTile( int x, int y ) const
 void GameWorld::addInputKey( int keycode, int unicode )
 {
   using namespace Defines;
+
+  if ( d->replayRecorder ) {
+    d->replayRecorder->addKey( keycode, unicode );
+  }
+
   switch ( keycode )
   {
     case Z_Unicode:
@@ -553,6 +679,16 @@ AbstractMusicStream *GameWorld::musicStream() const
   return d->musicStream;
 }
 
+Randomizer &GameWorld::randomizer()
+{
+  return d->randomizer;
+}
+
+SymbolTable &GameWorld::symbols()
+{
+  return d->symbols;
+}
+
 void GameWorld::setScrollView( ScrollView *view )
 {
   d->scrollView = view;
@@ -573,16 +709,76 @@ int GameWorld::frameCycle() const
   return d->cycleSetting;
 }
 
+void GameWorld::setTurbo( int factor )
+{
+  d->turboFactor = ( factor > 1 ) ? factor : 1;
+  zdebug() << "GameWorld::setTurbo" << d->turboFactor;
+}
+
+int GameWorld::turbo() const
+{
+  return d->turboFactor;
+}
+
+void GameWorld::setRewindBuffer( RewindBuffer *buffer )
+{
+  d->rewindBuffer = buffer;
+}
+
+RewindBuffer *GameWorld::rewindBuffer() const
+{
+  return d->rewindBuffer;
+}
+
+void GameWorld::setReplayRecorder( ReplayRecorder *recorder )
+{
+  d->replayRecorder = recorder;
+}
+
+ReplayRecorder *GameWorld::replayRecorder() const
+{
+  return d->replayRecorder;
+}
+
+void GameWorld::setScriptClock( AbstractClock *clock )
+{
+  d->scriptClock = clock;
+}
+
+AbstractClock *GameWorld::scriptClock() const
+{
+  return d->scriptClock;
+}
+
+void GameWorld::setFrameStats( FrameStats *stats )
+{
+  d->frameStats = stats;
+}
+
+FrameStats *GameWorld::frameStats() const
+{
+  return d->frameStats;
+}
+
+void GameWorld::addScriptError()
+{
+  d->scriptErrors += 1;
+}
+
+int GameWorld::scriptErrors() const
+{
+  return d->scriptErrors;
+}
+
 void GameWorld::doCheat( const ZString &code )
 {
-  ZString c = code.upper();
-  zdebug() << "CHEAT:" << c;
+  zdebug() << "CHEAT:" << code;
 
-  if ( c == "ammo" ) { setCurrentAmmo( currentAmmo() + 5 ); }
-  else if ( c == "health" ) { setCurrentHealth( currentHealth() + 10 ); }
-  else if ( c == "gems" ) { setCurrentGems( currentGems() + 5 ); }
-  else if ( c == "torches" ) { setCurrentTorches( currentTorches() + 5 ); }
-  else if ( c == "keys" ) {
+  if ( code.equalsNoCase( "ammo" ) ) { setCurrentAmmo( currentAmmo() + 5 ); }
+  else if ( code.equalsNoCase( "health" ) ) { setCurrentHealth( currentHealth() + 10 ); }
+  else if ( code.equalsNoCase( "gems" ) ) { setCurrentGems( currentGems() + 5 ); }
+  else if ( code.equalsNoCase( "torches" ) ) { setCurrentTorches( currentTorches() + 5 ); }
+  else if ( code.equalsNoCase( "keys" ) ) {
     for ( int i = GameWorld::BLUE_DOORKEY; i <= GameWorld::WHITE_DOORKEY; i++ ) {
       addDoorKey(i);
     }
@@ -597,3 +793,193 @@ Illuminate room                   -DARK
 Obfuscate room                    DARK
 */
 
+
+// ---------------------------------------------------------------------------
+
+void GameWorldPrivate::saveState( SnapshotWriter &out ) const
+{
+  out.putWord( startBoard );
+  out.putInt( currentAmmo );
+  out.putInt( currentGems );
+  out.putInt( currentHealth );
+  out.putInt( currentTorches );
+  out.putInt( currentTorchCycles );
+  out.putInt( currentScore );
+  out.putInt( currentEnergizerCycles );
+  out.putInt( currentTimePassed );
+  for ( int i = 0; i < GameWorld::max_doorkey; i++ ) {
+    out.putBool( doorKeys[i] );
+  }
+
+  out.putString( worldTitle );
+  out.putWord( gameFlags.size() );
+  for ( unsigned int i = 0; i < gameFlags.size(); i++ ) {
+    out.putString( symbols.name( gameFlags[i] ) );
+  }
+
+  out.putInt( self->currentIndex() );
+  out.putInt( boardSwitch );
+  out.putInt( cycleCountdown );
+  out.putDWord( randomizer.state() );
+}
+
+bool GameWorldPrivate::readState( SnapshotReader &in, WorldState &state )
+{
+  state.startBoard = in.getWord();
+  state.currentAmmo = in.getInt();
+  state.currentGems = in.getInt();
+  state.currentHealth = in.getInt();
+  state.currentTorches = in.getInt();
+  state.currentTorchCycles = in.getInt();
+  state.currentScore = in.getInt();
+  state.currentEnergizerCycles = in.getInt();
+  state.currentTimePassed = in.getInt();
+  for ( int i = 0; i < GameWorld::max_doorkey; i++ ) {
+    state.doorKeys[i] = in.getBool();
+  }
+
+  state.worldTitle = in.getString();
+  state.gameFlags.clear();
+  const int flagCount = in.getWord();
+  for ( int i = 0; i < flagCount && in.ok(); i++ ) {
+    state.gameFlags.push_back( in.getString() );
+  }
+
+  state.currentIndex = in.getInt();
+  state.boardSwitch = in.getInt();
+  state.cycleCountdown = in.getInt();
+  state.randomState = in.getDWord();
+  return in.ok();
+}
+
+void GameWorldPrivate::applyState( const WorldState &state )
+{
+  startBoard = state.startBoard;
+  currentAmmo = state.currentAmmo;
+  currentGems = state.currentGems;
+  currentHealth = state.currentHealth;
+  currentTorches = state.currentTorches;
+  currentTorchCycles = state.currentTorchCycles;
+  currentScore = state.currentScore;
+  currentEnergizerCycles = state.currentEnergizerCycles;
+  currentTimePassed = state.currentTimePassed;
+  for ( int i = 0; i < GameWorld::max_doorkey; i++ ) {
+    doorKeys[i] = state.doorKeys[i];
+  }
+
+  worldTitle = state.worldTitle;
+  gameFlags.clear();
+  for ( unsigned int i = 0; i < state.gameFlags.size(); i++ ) {
+    self->addGameFlag( state.gameFlags[i] );
+  }
+
+  cycleCountdown = state.cycleCountdown;
+  randomizer.seed( state.randomState );
+
+  self->setCurrentBoard( self->getBoard( state.currentIndex ) );
+  boardSwitch = state.boardSwitch;
+}
+
+void GameWorld::saveSnapshot( WorldSnapshot &snapshot )
+{
+  SnapshotBytes worldBytes;
+  SnapshotWriter worldWriter( worldBytes );
+  d->saveState( worldWriter );
+  snapshot.worldState = SnapshotBlob( worldBytes );
+
+  snapshot.boards.clear();
+  snapshot.boards.resize( d->maxBoards );
+
+  GameBoardMap::iterator iter;
+  for( iter = d->boards.begin(); iter != d->boards.end(); ++iter ) {
+    const int index = (*iter).first;
+    GameBoard *board = (*iter).second;
+    SyncedBoard &synced = d->syncedBoards[index];
+
+    if ( synced.blob.isNull() || synced.revision != board->revision() ) {
+      SnapshotBytes bytes;
+      SnapshotWriter writer( bytes );
+      board->saveState( writer );
+      synced.blob = SnapshotBlob( bytes );
+      synced.revision = board->revision();
+    }
+
+    snapshot.boards[index] = synced.blob;
+  }
+}
+
+bool GameWorld::restoreSnapshot( const WorldSnapshot &snapshot )
+{
+  if ( snapshot.isNull() ) {
+    return false;
+  }
+
+  // everything gets read into temporaries first, so a bad snapshot leaves
+  // the world exactly as it was instead of half restored.
+  WorldState state;
+  SnapshotReader reader( snapshot.worldState.data(), snapshot.worldState.size() );
+  if ( !GameWorldPrivate::readState( reader, state ) ) {
+    zwarn() << "GameWorld::restoreSnapshot: bad world state";
+    return false;
+  }
+
+  GameBoardMap restored;
+  bool ok = true;
+  for ( unsigned int index = 0; ok && index < snapshot.boards.size(); index++ ) {
+    const SnapshotBlob &blob = snapshot.boards[index];
+    if ( blob.isNull() ) {
+      continue;
+    }
+
+    GameBoard *board = getBoard( index );
+    SyncedBoardMap::const_iterator synced = d->syncedBoards.find( index );
+    if ( board && synced != d->syncedBoards.end() &&
+         (*synced).second.blob.sameAs( blob ) &&
+         (*synced).second.revision == board->revision() ) {
+      // untouched since that snapshot, nothing to do
+      continue;
+    }
+
+    GameBoard *fresh = new GameBoard();
+    fresh->setWorld( this );
+    restored[index] = fresh;
+
+    SnapshotReader boardReader( blob.data(), blob.size() );
+    if ( !fresh->loadState( boardReader ) ) {
+      zwarn() << "GameWorld::restoreSnapshot: bad board" << index;
+      ok = false;
+    }
+  }
+
+  // -1 is a world saved before anything picked a board for it
+  if ( ok && state.currentIndex != -1 &&
+       restored.find( state.currentIndex ) == restored.end() &&
+       !getBoard( state.currentIndex ) ) {
+    zwarn() << "GameWorld::restoreSnapshot: no board" << state.currentIndex;
+    ok = false;
+  }
+
+  GameBoardMap::iterator iter;
+  if ( !ok ) {
+    for ( iter = restored.begin(); iter != restored.end(); ++iter ) {
+      delete (*iter).second;
+    }
+    return false;
+  }
+
+  // all good, swap the new boards in
+  for ( iter = restored.begin(); iter != restored.end(); ++iter ) {
+    const int index = (*iter).first;
+    GameBoard *board = (*iter).second;
+    delete getBoard( index );
+    addBoard( index, board );
+
+    SyncedBoard &synced = d->syncedBoards[index];
+    synced.blob = snapshot.boards[index];
+    synced.revision = board->revision();
+  }
+
+  d->applyState( state );
+  return true;
+}
+
@@ -13,6 +13,14 @@ class AbstractPainter;
 class AbstractMusicStream;
 class GameWorldPrivate;
 class ScrollView;
+class WorldSnapshot;
+class RewindBuffer;
+class ReplayRecorder;
+class Randomizer;
+class SymbolTable;
+class ZStringView;
+class AbstractClock;
+class FrameStats;
 
 /// A complete gameworld that can be played.
 class GameWorld
@@ -118,11 +126,15 @@ class GameWorld
     const ZString &worldTitle() const;
 
     /// adds a game flag
-    void addGameFlag( const ZString &flag );
+    void addGameFlag( const ZStringView &flag );
     /// removes a game flag
-    void removeGameFlag( const ZString &flag );
+    void removeGameFlag( const ZStringView &flag );
     /// accessor
-    bool hasGameFlag( const ZString &flag );
+    bool hasGameFlag( const ZStringView &flag );
+    /// number of flags set, never more than 10
+    int gameFlagCount() const;
+    /// one of the set flags, upper cased, in the order they were set
+    ZString gameFlag( int index ) const;
 
     /// starts an input key press
     void addInputKey( int keycode, int unicode );
@@ -150,8 +162,9 @@ class GameWorld
     /// accessor
     bool transitionTile( int x, int y ) const;
 
-    /// based on the frame delay setting, does nothing or runs update
-    void update();
+    /// based on the frame delay setting, does nothing or runs exec.
+    /// returns true if exec ran.
+    bool update();
 
     /// runs one cycle of the world
     void exec();
@@ -164,6 +177,12 @@ class GameWorld
     /// accessor
     AbstractMusicStream *musicStream() const;
 
+    /// every random roll the world's things make comes from here
+    Randomizer &randomizer();
+
+    /// object names, flags and labels, as the world's symbols
+    SymbolTable &symbols();
+
     /// scroll for manipulating
     void setScrollView( ScrollView *view );
     /// accessor
@@ -175,9 +194,47 @@ class GameWorld
     /// gets the frame delay setting
     int frameCycle() const;
 
+    /// runs this many cycles per update, ignoring the frame delay. 1 is off.
+    void setTurbo( int factor );
+
+    /// accessor
+    int turbo() const;
+
+    /// records every cycle into the buffer, 0 to stop
+    void setRewindBuffer( RewindBuffer *buffer );
+    /// accessor
+    RewindBuffer *rewindBuffer() const;
+
+    /// hands input, paints and cycles to the recorder, 0 to stop
+    void setReplayRecorder( ReplayRecorder *recorder );
+    /// accessor
+    ReplayRecorder *replayRecorder() const;
+
+    /// times every ZZT-OOP run with this clock, 0 to only count
+    void setScriptClock( AbstractClock *clock );
+    /// accessor
+    AbstractClock *scriptClock() const;
+
+    /// exec and board timings for the F2 overlay, 0 to not time anything
+    void setFrameStats( FrameStats *stats );
+    /// accessor
+    FrameStats *frameStats() const;
+
     /// activates a cheat code
     void doCheat( const ZString &code );
 
+    /// counts a ZZT-OOP error raised by one of the world's objects
+    void addScriptError();
+    /// accessor
+    int scriptErrors() const;
+
+    /// saves the running state. Boards unchanged since the last save or
+    /// restore share their bytes with the previous snapshot.
+    void saveSnapshot( WorldSnapshot &snapshot );
+    /// puts the world back the way the snapshot found it, only reloading
+    /// boards that changed. false on bad data.
+    bool restoreSnapshot( const WorldSnapshot &snapshot );
+
   private:
     GameWorldPrivate *d;
 };
@@ -323,6 +323,12 @@ ThingFactory::ThingFactory()
   /* */
 }
 
+ThingFactory::~ThingFactory()
+{
+  delete d;
+  d = 0;
+}
+
 GameWorld *ThingFactory::world() const
 {
   return d->world;
@@ -343,16 +349,65 @@ void ThingFactory::setBoard( GameBoard *board )
   d->board = board;
 }
 
-AbstractThing * ThingFactory::createThing( const unsigned char *data, int &thingSize )
+AbstractThing * ThingFactory::createThing( const ZZTReader &data, int &thingSize )
 {
-  std::auto_ptr<ThingHeader> header( new ThingHeader(data) );
+  if ( !data.fits( 0, ThingHeader::size ) ) {
+    thingSize = -1;
+    return 0;
+  }
+
+  const ThingHeader header( data );
+
+  // a negative length borrows another thing's program, and takes no bytes
+  const int programSize = header.programLength > 0 ? header.programLength : 0;
+  if ( !data.fits( ThingHeader::size, programSize ) ) {
+    thingSize = -1;
+    return 0;
+  }
 
   // Really ZZT file format, I have to look at the board to get the
   // entity number? Why didn't you encode it, you had 7 unused bytes there.
-  ZZTEntity entity = d->board->entity( header->x - 1, header->y - 1 );
+  ZZTEntity entity = d->board->entity( header.x - 1, header.y - 1 );
 
-  thingSize = 0x21 + header->programLength;
+  thingSize = ThingHeader::size + programSize;
 
-  return d->createThing( entity, *header, (data + 0x21) );
+  AbstractThing *thing = d->createThing( entity, header, data.data() + ThingHeader::size );
+  if ( thing ) {
+    thing->setFileHeader( data.data(), ThingHeader::size );
+  }
+  return thing;
 }
 
+
+AbstractThing * ThingFactory::createEmptyThing( unsigned char id )
+{
+  AbstractThing *thing = 0;
+  switch ( id )
+  {
+    case ZZTEntity::Player:           thing = new Player(); break;
+    case ZZTEntity::Scroll:           thing = new Scroll(); break;
+    case ZZTEntity::Passage:          thing = new Passage(); break;
+    case ZZTEntity::Duplicator:       thing = new Duplicator(); break;
+    case ZZTEntity::Bear:             thing = new Bear(); break;
+    case ZZTEntity::Ruffian:          thing = new Ruffian(); break;
+    case ZZTEntity::Object:           thing = new Object(); break;
+    case ZZTEntity::Slime:            thing = new Slime(); break;
+    case ZZTEntity::Shark:            thing = new Shark(); break;
+    case ZZTEntity::SpinningGun:      thing = new SpinningGun(); break;
+    case ZZTEntity::Pusher:           thing = new Pusher(); break;
+    case ZZTEntity::Lion:             thing = new Lion(); break;
+    case ZZTEntity::Tiger:            thing = new Tiger(); break;
+    case ZZTEntity::CentipedeHead:    thing = new CentipedeHead(); break;
+    case ZZTEntity::CentipedeSegment: thing = new CentipedeSegment(); break;
+    case ZZTEntity::BlinkWall:        thing = new BlinkWall(); break;
+    case ZZTEntity::Transporter:      thing = new Transporter(); break;
+    case ZZTEntity::Bullet:           thing = new Bullet(); break;
+    case ZZTEntity::Star:             thing = new Star(); break;
+    default: break;
+  }
+
+  if ( thing ) {
+    thing->setBoard( d->board );
+  }
+  return thing;
+}
@@ -10,6 +10,7 @@
 
 class GameWorld;
 class GameBoard;
+class ZZTReader;
 
 namespace ZZTThing {
   class AbstractThing;
@@ -20,6 +21,7 @@ class ThingFactory
 {
   public:
     ThingFactory();
+    ~ThingFactory();
 
     GameWorld *world() const;
     void setWorld( GameWorld *world );
@@ -27,7 +29,12 @@ class ThingFactory
     GameBoard *board() const;
     void setBoard( GameBoard *board );
 
-    ZZTThing::AbstractThing *createThing( const unsigned char *data, int &thingSize );
+    /// data starts at the thing and runs to the end of the board.
+    /// thingSize is -1 when the thing doesn't fit in it.
+    ZZTThing::AbstractThing *createThing( const ZZTReader &data, int &thingSize );
+
+    /// bare thing of the given entity id, for restoring snapshots into
+    ZZTThing::AbstractThing *createEmptyThing( unsigned char id );
 
   private:
     ThingFactoryPrivate *d;
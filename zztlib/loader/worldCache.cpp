@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sys/stat.h>
+
+#include "debug.h"
+#include "zstring.h"
+#include "snapshotStream.h"
+#include "worldSnapshot.h"
+#include "gameWorld.h"
+#include "gameBoard.h"
+#include "worldCache.h"
+
+static const char cacheMagic[] = "ZWCH";
+static const unsigned short cacheVersion = 2;
+
+// ---------------------------------------------------------------------------
+
+WorldCache::WorldCache( const ZString &worldFile )
+  : m_worldFile( worldFile ),
+    m_cacheFile( cacheFileName( worldFile ) ),
+    m_mtime( -1 ),
+    m_size( -1 )
+{
+  struct stat inode;
+  if ( stat( worldFile.c_str(), &inode ) == 0 ) {
+    m_mtime = inode.st_mtime;
+    m_size = inode.st_size;
+  }
+}
+
+ZString WorldCache::cacheFileName( const ZString &worldFile )
+{
+  return worldFile + ".fzc";
+}
+
+bool WorldCache::load( GameWorld *world ) const
+{
+  using namespace std;
+
+  if ( m_size < 0 ) return false;
+
+  // one read for the lot, everything after is decoded in place
+  ifstream file( m_cacheFile.c_str(), ios::in|ios::binary|ios::ate );
+  if ( !file.is_open() || !file.good() ) {
+    return false;
+  }
+  SnapshotBytes bytes( file.tellg() );
+  file.seekg( 0, ios::beg );
+  if ( bytes.empty() ) return false;
+  file.read( (char *) &bytes[0], bytes.size() );
+  if ( !file.good() ) return false;
+
+  SnapshotReader in( &bytes[0], bytes.size() );
+  const unsigned char *magic = in.getBytes( 4 );
+  if ( !magic || ZString( (const char *) magic, 4 ) != cacheMagic ||
+       in.getWord() != cacheVersion ) {
+    zwarn() << "WorldCache: ignoring" << m_cacheFile;
+    return false;
+  }
+
+  long long mtime = in.getDWord();
+  mtime |= (long long) in.getDWord() << 32;
+  const long long size = in.getDWord();
+  if ( mtime != m_mtime || size != m_size ) {
+    zinfo() << "WorldCache: stale" << m_cacheFile;
+    return false;
+  }
+
+  const unsigned int stateLength = in.getDWord();
+  const unsigned char *state = in.getBytes( stateLength );
+
+  const int boardCount = in.getWord();
+  for ( int i = 0; i < boardCount && in.ok(); i++ ) {
+    const ZString title = in.getString();
+    const unsigned int length = in.getDWord();
+    const unsigned char *data = in.getBytes( length );
+    if ( !data || length == 0 ) continue;
+
+    // boards read straight out of the file's bytes, packed fields and all
+    GameBoard *board = new GameBoard();
+    world->addBoard( i, board );
+    board->setTitle( title );
+    SnapshotReader boardIn( data, length );
+    if ( !board->loadState( boardIn, true ) ) {
+      in.fail();
+    }
+  }
+
+  // counters and flags go through a snapshot holding nothing else, which
+  // also lands the world on its current board, none for a fresh load
+  WorldSnapshot snapshot;
+  if ( in.ok() && state ) {
+    SnapshotBytes stateBytes( state, state + stateLength );
+    snapshot.worldState = SnapshotBlob( stateBytes );
+  }
+  if ( !in.ok() || !world->restoreSnapshot( snapshot ) ) {
+    zwarn() << "WorldCache: bad cache" << m_cacheFile;
+    return false;
+  }
+
+  zinfo() << "WorldCache: loaded" << m_cacheFile;
+  return true;
+}
+
+bool WorldCache::save( GameWorld *world ) const
+{
+  if ( m_size < 0 ) return false;
+
+  WorldSnapshot snapshot;
+  world->saveSnapshot( snapshot );
+
+  SnapshotBytes bytes;
+  SnapshotWriter out( bytes );
+  out.putBytes( (const unsigned char *) cacheMagic, 4 );
+  out.putWord( cacheVersion );
+  out.putDWord( m_mtime & 0xffffffff );
+  out.putDWord( m_mtime >> 32 );
+  out.putDWord( m_size );
+
+  out.putDWord( snapshot.worldState.size() );
+  out.putBytes( snapshot.worldState.data(), snapshot.worldState.size() );
+
+  out.putWord( world->maxBoards() );
+  for ( int i = 0; i < world->maxBoards(); i++ ) {
+    GameBoard *board = world->getBoard( i );
+    if ( !board ) {
+      out.putString( ZString() );
+      out.putDWord( 0 );
+      continue;
+    }
+
+    SnapshotBytes boardBytes;
+    SnapshotWriter boardOut( boardBytes );
+    board->saveState( boardOut, true );
+    out.putString( board->title() );
+    out.putDWord( boardBytes.size() );
+    out.putBytes( &boardBytes[0], boardBytes.size() );
+  }
+
+  // written beside the cache and renamed over it, so a crash or a full
+  // disk halfway through leaves the old one whole instead of truncated
+  const ZString tempFile = m_cacheFile + ".tmp";
+  std::ofstream file( tempFile.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+  if ( !file.is_open() ) {
+    // read-only directories just don't get a cache
+    zdebug() << "WorldCache: couldn't write" << tempFile;
+    return false;
+  }
+  file.write( (const char *) &bytes[0], bytes.size() );
+  file.close();
+  if ( !file.good() ) {
+    zdebug() << "WorldCache: couldn't write" << tempFile;
+    std::remove( tempFile.c_str() );
+    return false;
+  }
+
+  if ( std::rename( tempFile.c_str(), m_cacheFile.c_str() ) != 0 ) {
+    // windows won't rename over an existing file
+    std::remove( m_cacheFile.c_str() );
+    if ( std::rename( tempFile.c_str(), m_cacheFile.c_str() ) != 0 ) {
+      zdebug() << "WorldCache: couldn't replace" << m_cacheFile;
+      std::remove( tempFile.c_str() );
+      return false;
+    }
+  }
+  return true;
+}
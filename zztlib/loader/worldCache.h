@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef WORLD_CACHE_H
+#define WORLD_CACHE_H
+
+#include "zstring.h"
+
+class GameWorld;
+
+/// A freshly loaded world kept as a snapshot, in a file beside the zzt
+/// world it came from. Restoring it skips the RLE and the stat parsing,
+/// and the file's size and mtime say when it has gone stale.
+class WorldCache
+{
+  public:
+    WorldCache( const ZString &worldFile );
+
+    /// where the cache for worldFile lives
+    static ZString cacheFileName( const ZString &worldFile );
+
+    /// fills an empty world from the cache, false if it's missing or stale
+    bool load( GameWorld *world ) const;
+
+    /// writes a world that was just loaded from worldFile
+    bool save( GameWorld *world ) const;
+
+  private:
+    ZString m_worldFile;
+    ZString m_cacheFile;
+    long long m_mtime;
+    long long m_size;
+};
+
+#endif // WORLD_CACHE_H
@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "debug.h"
+#include "zstring.h"
+#include "snapshotStream.h"
+#include "zztStructs.h"
+#include "worldIndex.h"
+
+/// board is the whole board, size word included. Only the run lengths
+/// get looked at on the way to the board information.
+static bool scanBoard( const ZZTReader &board, BoardIndex &index )
+{
+  if ( !board.fits( 0, BoardHeader::size ) ) return false;
+  index.title = BoardHeader( board ).title;
+
+  int pos = BoardHeader::size;
+  int count = 0;
+  while ( count < 1500 ) {
+    if ( !board.fits( pos, 3 ) ) return false;
+    // same as the loader, a run of zero takes up a triplet and no tiles
+    count += board.byte( pos );
+    pos += 3;
+  }
+
+  if ( !board.fits( pos, BoardInformation::size ) ) return false;
+  BoardInformation info( board.window( pos, BoardInformation::size ) );
+  index.thingCount = info.thingCount;
+  return true;
+}
+
+static void readFlags( const WorldHeader &header, std::vector< ZFixedString<20> > &flags )
+{
+  for ( int x = 0; x < 10; x++ ) {
+    if ( !header.flags[x].empty() ) {
+      flags.push_back( header.flags[x] );
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+WorldIndex::WorldIndex()
+{
+  /* */
+}
+
+void WorldIndex::clear()
+{
+  title.clear();
+  flags.clear();
+  boards.clear();
+}
+
+bool WorldIndex::scan( const ZString &filename )
+{
+  using namespace std;
+
+  clear();
+
+  ifstream file( filename.c_str(), ios::in|ios::binary );
+  if ( !file.is_open() || !file.good() ) {
+    return false;
+  }
+
+  unsigned char headerData[WorldHeader::size];
+  if ( !file.read( (char*) headerData, WorldHeader::size ) ) return false;
+
+  WorldHeader header( ZZTReader( headerData, WorldHeader::size ) );
+  if ( header.magicKey != 0xffff ) return false;
+
+  const int boardCount = header.boardCount + 1;
+  if ( boardCount < 1 ) return false;
+
+  title = header.gameName;
+  readFlags( header, flags );
+
+  // one buffer big enough for any board gets reused for all of them
+  std::vector<unsigned char> board( 0x8001 );
+  for ( int x = 0; x < boardCount; x++ ) {
+    if ( !file.read( (char*) &board[0], 2 ) ) break;
+    const int size = BoardHeader::storedSize( ZZTReader( &board[0], 2 ) );
+    if ( size < 2 || !file.read( (char*) &board[2], size - 2 ) ) break;
+
+    BoardIndex index;
+    if ( !scanBoard( ZZTReader( &board[0], size ), index ) ) break;
+    boards.push_back( index );
+  }
+
+  if ( (int) boards.size() != boardCount ) {
+    zdebug() << "WorldIndex: truncated" << filename;
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+void WorldIndex::serialize( SnapshotWriter &out ) const
+{
+  out.putString( title );
+
+  out.putByte( flags.size() );
+  for ( unsigned int i = 0; i < flags.size(); i++ ) {
+    out.putString( flags[i] );
+  }
+
+  out.putWord( boards.size() );
+  for ( unsigned int i = 0; i < boards.size(); i++ ) {
+    out.putString( boards[i].title );
+    out.putWord( boards[i].thingCount );
+  }
+}
+
+bool WorldIndex::deserialize( SnapshotReader &in )
+{
+  clear();
+
+  title = in.getStringView();
+
+  const int flagCount = in.getByte();
+  for ( int i = 0; i < flagCount && in.ok(); i++ ) {
+    flags.push_back( ZFixedString<20>( in.getStringView() ) );
+  }
+
+  const int boardCount = in.getWord();
+  for ( int i = 0; i < boardCount && in.ok(); i++ ) {
+    BoardIndex index;
+    index.title = in.getStringView();
+    index.thingCount = (signed short) in.getWord();
+    boards.push_back( index );
+  }
+
+  if ( !in.ok() ) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
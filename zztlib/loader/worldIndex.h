@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef WORLD_INDEX_H
+#define WORLD_INDEX_H
+
+#include <vector>
+#include "zstring.h"
+#include "zfixedString.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+/// what the world browser shows about one board
+struct BoardIndex
+{
+  ZFixedString<50> title;
+  /// stats on the board, not counting the player
+  int thingCount;
+};
+
+/// The headers of a zzt world file, without decoding any of its boards.
+/// Boards get hopped over by their sizes, so this is cheap enough to run
+/// across a whole directory.
+class WorldIndex
+{
+  public:
+    WorldIndex();
+
+    void clear();
+
+    /// reads the file one board at a time
+    bool scan( const ZString &filename );
+
+    /// accessor
+    int boardCount() const { return boards.size(); };
+
+    void serialize( SnapshotWriter &out ) const;
+    bool deserialize( SnapshotReader &in );
+
+  public:
+    ZFixedString<20> title;
+    std::vector< ZFixedString<20> > flags;
+    std::vector<BoardIndex> boards;
+};
+
+#endif // WORLD_INDEX_H
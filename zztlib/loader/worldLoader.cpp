@@ -13,13 +13,17 @@
 #include <fstream>
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 
 #include "debug.h"
 #include "zstring.h"
+#include "zstringView.h"
+#include "abstractTaskPool.h"
 #include "gameWorld.h"
 #include "gameBoard.h"
 #include "thingFactory.h"
 #include "worldLoader.h"
+#include "worldCache.h"
 #include "zztEntity.h"
 #include "zztStructs.h"
 
@@ -29,13 +33,18 @@ class WorldLoaderPrivate
     WorldLoaderPrivate( WorldLoader *pSelf )
       : world( 0 ),
         worldData( 0 ),
+        fileSize( 0 ),
+        taskPool( 0 ),
         self(pSelf)
     { /* */ };
 
-    GameBoard *loadBoard( int &filePos );
+    GameBoard *loadBoard( int &filePos, ThingFactory &factory );
     bool readFieldDataRLE( GameBoard *board,
-                           int &filePos,
-                           int failSafeStopPos );
+                           const ZZTReader &data,
+                           int &pos );
+
+    bool scanBoards( int filePos, int boards, std::vector<int> &offsets );
+    bool loadBoardsParallel( int filePos, int boards );
 
   public:
     GameWorld *world;
@@ -45,90 +54,196 @@ class WorldLoaderPrivate
     int fileSize;
   
     ThingFactory thingFactory;
+    AbstractTaskPool *taskPool;
 
   private:
     WorldLoader *self;
 };
 
-GameBoard * WorldLoaderPrivate::loadBoard( int &filePos )
+GameBoard * WorldLoaderPrivate::loadBoard( int &filePos, ThingFactory &factory )
 {
-  std::auto_ptr<GameBoard > board( new GameBoard() );
-  board->setWorld( world );
-  board->clear();
+  const ZZTReader file( worldData, fileSize );
+  if ( !file.fits( filePos, BoardHeader::size ) ) {
+    zwarn() << "Board header runs past the end of the file.";
+    return 0;
+  }
 
-  std::auto_ptr<BoardHeader>
-      header( new BoardHeader(worldData + filePos) );
+  const BoardHeader header( file.window( filePos, BoardHeader::size ) );
 
   const int origFilePos = filePos;
-  const int endFilePos = filePos + header->sizeInBytes + 2;
+  const int endFilePos = filePos + header.sizeInBytes + 2;
 
   zinfo() << "Board header:"
-          << header->sizeInBytes
+          << header.sizeInBytes
           << origFilePos
           << endFilePos
-          << header->title;
+          << header.title;
 
-  filePos += 0x35;
+  // from here on nothing gets read from outside the board's own bytes
+  const ZZTReader data = file.window( filePos, header.sizeInBytes + 2 );
+  if ( header.sizeInBytes < BoardHeader::size - 2 || !data.size() ) {
+    zwarn() << "Board size doesn't fit in the file:" << header.sizeInBytes;
+    return 0;
+  }
 
-  bool rleSuccess = readFieldDataRLE( board.get(), filePos, endFilePos );
+  std::auto_ptr<GameBoard > board( new GameBoard() );
+  board->setWorld( world );
+  board->clear();
+  board->setTitle( header.title.str() );
+
+  int pos = BoardHeader::size;
+
+  bool rleSuccess = readFieldDataRLE( board.get(), data, pos );
   if (!rleSuccess) {
     zwarn() << "Failed to load RLE while loading board.";
     return 0;
   }
 
-  std::auto_ptr<BoardInformation>
-      info( new BoardInformation(worldData + filePos) );
+  if ( !data.fits( pos, BoardInformation::size ) ) {
+    zwarn() << "Board info runs past the end of the board.";
+    return 0;
+  }
+
+  const BoardInformation info( data.window( pos, BoardInformation::size ) );
 
   zinfo() << "Board info:"
-          << info->thingCount
-          << info->message;
+          << info.thingCount
+          << info.message;
 
-  board->setMessage( info->message );
-  board->setNorthExit( info->boardNorth );
-  board->setSouthExit( info->boardSouth );
-  board->setWestExit( info->boardWest );
-  board->setEastExit( info->boardEast );
-  board->setDark( info->darkness );
+  board->setMessage( info.message.str() );
+  board->setNorthExit( info.boardNorth );
+  board->setSouthExit( info.boardSouth );
+  board->setWestExit( info.boardWest );
+  board->setEastExit( info.boardEast );
+  board->setDark( info.darkness );
+  board->setFileInfo( data.data() + pos, BoardInformation::size );
 
-  filePos += 0x58;
+  pos += BoardInformation::size;
 
-  thingFactory.setBoard( board.get() );
+  factory.setBoard( board.get() );
 
-  for ( int x = 0; x < info->thingCount + 1; x++ )
+  for ( int x = 0; x < info.thingCount + 1; x++ )
   {
     int thingSize = 0;
     ZZTThing::AbstractThing *thing =
-        thingFactory.createThing( worldData + filePos, thingSize );
+        factory.createThing( data.window( pos, data.size() - pos ), thingSize );
+    if ( thingSize < 0 ) {
+      zwarn() << "Thing runs past the end of the board.";
+      return 0;
+    }
     if (thing) {
       board->addThing( thing );
     }
-    filePos += thingSize;
+    else if ( thingSize > 0 ) {
+      // nothing to run it, but it still goes back out with the board
+      const ThingHeader header( data.window( pos, ThingHeader::size ) );
+      const unsigned char id = board->entity( header.x - 1, header.y - 1 ).id();
+      board->addUnknownThing( id, data.data() + pos, thingSize );
+    }
+    pos += thingSize;
   }
 
-  zdebug() << "End of board file pos:" << filePos;
+  zdebug() << "End of board file pos:" << origFilePos + pos;
 
   filePos = endFilePos;
   return board.release();
 }
 
 bool WorldLoaderPrivate::readFieldDataRLE( GameBoard *board,
-                                           int &filePos,
-                                           int failSafeStopPos )
+                                           const ZZTReader &data,
+                                           int &pos )
 {
   int reps, id, color;
   int count = 0;
 
-  while ( count < 1500 && filePos < failSafeStopPos )
+  while ( count < 1500 )
   {
-    reps = (int) worldData[filePos++];
-    id = (int) worldData[filePos++];
-    color = (int) worldData[filePos++];
-
-    for ( int x = 0; x < reps && count < 1500; x++ ) {
-      ZZTEntity entity = ZZTEntity::createEntity( id, color );
-      board->setEntity( count % 60, count / 60, entity );
-      count += 1;
+    // the board has to hold all 1500 tiles, anything short is corrupt
+    if ( !data.fits( pos, 3 ) ) return false;
+
+    reps = (int) data.data()[pos++];
+    id = (int) data.data()[pos++];
+    color = (int) data.data()[pos++];
+
+    // one entity per run, the board copies it down the span
+    const int span = std::min( reps, 1500 - count );
+    board->fillEntities( count, span, ZZTEntity::createEntity( id, color ) );
+    count += span;
+  }
+  return true;
+}
+
+bool WorldLoaderPrivate::scanBoards( int filePos, int boards,
+                                     std::vector<int> &offsets )
+{
+  // every board leads with its size, so hop from one to the next
+  const ZZTReader file( worldData, fileSize );
+  offsets.clear();
+  for ( int x = 0; x < boards; x++ ) {
+    if ( !file.fits( filePos, 2 ) ) return false;
+    const int size = BoardHeader::storedSize( file.window( filePos, 2 ) );
+    if ( !file.fits( filePos, size ) ) return false;
+    offsets.push_back( filePos );
+    filePos += size;
+  }
+  return true;
+}
+
+/// decodes one board on the pool, with its own ThingFactory
+class BoardTask : public AbstractTask
+{
+  public:
+    BoardTask()
+      : loader( 0 ),
+        filePos( 0 ),
+        board( 0 )
+    { /* */ };
+
+    virtual void run()
+    {
+      ThingFactory factory;
+      factory.setWorld( loader->world );
+      int pos = filePos;
+      board = loader->loadBoard( pos, factory );
+    };
+
+    WorldLoaderPrivate *loader;
+    int filePos;
+    GameBoard *board;
+};
+
+bool WorldLoaderPrivate::loadBoardsParallel( int filePos, int boards )
+{
+  std::vector<int> offsets;
+  if ( !scanBoards( filePos, boards, offsets ) ) {
+    zwarn() << "Board sizes run past the end of the file.";
+    return false;
+  }
+
+  // the tasks vector is done growing, so pointers into it stay put
+  std::vector<BoardTask> tasks( boards );
+  for ( int x = 0; x < boards; x++ ) {
+    tasks[x].loader = this;
+    tasks[x].filePos = offsets[x];
+    taskPool->add( &tasks[x] );
+  }
+  taskPool->wait();
+
+  bool success = true;
+  for ( int x = 0; x < boards; x++ ) {
+    if ( !tasks[x].board ) success = false;
+  }
+
+  if ( !success ) {
+    for ( int x = 0; x < boards; x++ ) {
+      delete tasks[x].board;
     }
+    return false;
+  }
+
+  // attached in order, same as the serial path
+  for ( int x = 0; x < boards; x++ ) {
+    world->addBoard( x, tasks[x].board );
   }
   return true;
 }
@@ -162,7 +277,7 @@ WorldLoader::WorldLoader( const ZString &filename )
 WorldLoader::~WorldLoader()
 {
   if (d->worldData) {
-    delete d->worldData;
+    delete[] d->worldData;
   }
 
   delete d;
@@ -179,6 +294,11 @@ void WorldLoader::setWorld( GameWorld *target )
   d->world = target;
 }
 
+void WorldLoader::setTaskPool( AbstractTaskPool *pool )
+{
+  d->taskPool = pool;
+}
+
 bool WorldLoader::go()
 {
   if ( !isValid() ) {
@@ -189,8 +309,14 @@ bool WorldLoader::go()
 
   int filePos = 0;
 
+  const ZZTReader file( d->worldData, d->fileSize );
+  if ( !file.fits( 0, WorldHeader::size ) ) {
+    zwarn() << "Too short to be a ZZT world file!";
+    return false;
+  }
+
   std::auto_ptr<WorldHeader>
-      header( new WorldHeader(d->worldData) );
+      header( new WorldHeader( file ) );
 
   zinfo() << "Magickey:" << header->magicKey;
   if ( header->magicKey != 0xffff ) {
@@ -198,7 +324,7 @@ bool WorldLoader::go()
     return false;
   }
  
-  d->world->setWorldTitle( header->gameName );
+  d->world->setWorldTitle( header->gameName.str() );
   zinfo() << "GameName:" << d->world->worldTitle();
 
   // load counters
@@ -242,7 +368,7 @@ bool WorldLoader::go()
 
   // load gameflags
   for ( int x = 0; x < 10; x++ ) {
-    ZString str = header->flags[x];
+    const ZStringView str = header->flags[x].view();
     if ( !str.empty() ) {
       d->world->addGameFlag( str );
       zinfo() << "Flag:" << str;
@@ -251,10 +377,22 @@ bool WorldLoader::go()
 
   int boards = header->boardCount + 1;
   zinfo() << "Adding boards:" << boards;
-  filePos += 0x200;
+  if ( boards < 1 ) {
+    zwarn() << "World has no boards:" << header->boardCount;
+    return false;
+  }
+  filePos += WorldHeader::size;
+
+  if ( d->taskPool && d->taskPool->threadCount() > 1 && boards > 1 ) {
+    if ( !d->loadBoardsParallel( filePos, boards ) ) {
+      zwarn() << "Error loading world.";
+      return false;
+    }
+    return true;
+  }
 
   for ( int x = 0; x < boards; x++ ) {
-    GameBoard *board = d->loadBoard(filePos);
+    GameBoard *board = d->loadBoard( filePos, d->thingFactory );
     if (!board) {
       zwarn() << "Error loading world.";
       return false;
@@ -267,8 +405,19 @@ bool WorldLoader::go()
 
 // ---------------------------------------------------------------------------
 
-GameWorld * WorldLoader::loadWorld( const ZString &filename )
+GameWorld * WorldLoader::loadWorld( const ZString &filename,
+                                    AbstractTaskPool *pool,
+                                    bool useCache )
 {
+  const WorldCache cache( filename );
+  if ( useCache ) {
+    GameWorld *cached = new GameWorld();
+    if ( cache.load( cached ) ) {
+      return cached;
+    }
+    delete cached;
+  }
+
   WorldLoader loader( filename );
   if (!loader.isValid()) {
     return 0;
@@ -276,6 +425,7 @@ GameWorld * WorldLoader::loadWorld( const ZString &filename )
 
   GameWorld *world = new GameWorld();
   loader.setWorld(world);
+  loader.setTaskPool(pool);
 
   bool success = loader.go();
   if (!success) {
@@ -283,6 +433,10 @@ GameWorld * WorldLoader::loadWorld( const ZString &filename )
     return 0;
   }
 
+  if ( useCache ) {
+    cache.save( world );
+  }
+
   return world;
 }
 
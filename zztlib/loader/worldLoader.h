@@ -10,6 +10,7 @@
 
 class ZString;
 class GameWorld;
+class AbstractTaskPool;
 class WorldLoaderPrivate;
 
 /// Loads a complete version 3.2 zzt world file into a GameWorld object.
@@ -25,11 +26,18 @@ class WorldLoader
     /// provide GameWorld object to load file into
     void setWorld( GameWorld *target );
 
+    /// boards get decoded on the pool when set, 0 decodes them in order
+    void setTaskPool( AbstractTaskPool *pool );
+
     /// Does the deed of loading the world file
     bool go();
 
-    /// Convienience function to return a readied GameWord object
-    static GameWorld * loadWorld( const ZString &filename );
+    /// Convienience function to return a readied GameWord object.
+    /// With useCache, a fresh WorldCache beside the file is used instead,
+    /// and one gets written after parsing when there isn't.
+    static GameWorld * loadWorld( const ZString &filename,
+                                  AbstractTaskPool *pool = 0,
+                                  bool useCache = false );
 
   private:
     WorldLoaderPrivate *d;
@@ -0,0 +1,429 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+#include "debug.h"
+#include "zstring.h"
+#include "snapshotStream.h"
+#include "gameWorld.h"
+#include "gameBoard.h"
+#include "zztEntity.h"
+#include "zztThing.h"
+#include "enemies.h"
+#include "scriptable.h"
+#include "zztoopInterp.h"
+#include "zztStructs.h"
+#include "worldWriter.h"
+
+using namespace ZZTThing;
+
+/// param4 for the things in a centipede, keyed by thing
+typedef std::map<const AbstractThing*, unsigned int> CentipedeLinks;
+
+class WorldWriterPrivate
+{
+  public:
+    WorldWriterPrivate( WorldWriter *pSelf )
+      : world( 0 ),
+        savegame( false ),
+        self( pSelf )
+    { /* */ };
+
+    bool writeWorldHeader( SnapshotWriter &out );
+    bool writeBoard( SnapshotBytes &bytes, GameBoard *board );
+    void writeFieldDataRLE( SnapshotWriter &out, GameBoard *board );
+    void writeThing( SnapshotWriter &out, const SnapshotTable &table,
+                     const CentipedeLinks &links, int index );
+    void fillThingHeader( ThingHeader &header, const AbstractThing *thing );
+    void linkCentipedes( const SnapshotTable &table, CentipedeLinks &links );
+
+  public:
+    GameWorld *world;
+    bool savegame;
+
+  private:
+    WorldWriter *self;
+};
+
+/// what the world file had, all zeros when it didn't come from one
+static ZZTReader fileBytes( const std::vector<unsigned char> &bytes )
+{
+  return bytes.empty() ? ZZTReader( 0, 0 ) : ZZTReader( &bytes[0], bytes.size() );
+}
+
+bool WorldWriterPrivate::writeWorldHeader( SnapshotWriter &out )
+{
+  // zzt boards are numbered in order, there's no leaving gaps
+  for ( int x = 0; x < world->maxBoards(); x++ ) {
+    if ( !world->getBoard( x ) ) {
+      zwarn() << "WorldWriter: missing board" << x;
+      return false;
+    }
+  }
+
+  WorldHeader header;
+  header.magicKey = 0xffff;
+  header.boardCount = world->maxBoards() - 1;
+  header.ammo = world->currentAmmo();
+  header.gems = world->currentGems();
+
+  header.blueKey = world->hasDoorKey( GameWorld::BLUE_DOORKEY );
+  header.greenKey = world->hasDoorKey( GameWorld::GREEN_DOORKEY );
+  header.cyanKey = world->hasDoorKey( GameWorld::CYAN_DOORKEY );
+  header.redKey = world->hasDoorKey( GameWorld::RED_DOORKEY );
+  header.purpleKey = world->hasDoorKey( GameWorld::PURPLE_DOORKEY );
+  header.yellowKey = world->hasDoorKey( GameWorld::YELLOW_DOORKEY );
+  header.whiteKey = world->hasDoorKey( GameWorld::WHITE_DOORKEY );
+
+  header.health = world->currentHealth();
+  header.startBoard = ( savegame && world->currentBoard() )
+                    ? world->currentIndex()
+                    : world->startBoard();
+  header.torches = world->currentTorches();
+  header.torchCycles = world->currentTorchCycles();
+  header.energizerCycles = world->currentEnergizerCycles();
+  header.score = world->currentScore();
+  header.gameName = world->worldTitle();
+
+  for ( int x = 0; x < world->gameFlagCount() && x < 10; x++ ) {
+    header.flags[x] = world->gameFlag( x );
+  }
+
+  header.time = world->currentTimePassed();
+  header.savegame = savegame;
+
+  header.write( out );
+  return true;
+}
+
+bool WorldWriterPrivate::writeBoard( SnapshotBytes &bytes, GameBoard *board )
+{
+  SnapshotWriter out( bytes );
+  const unsigned int start = out.size();
+
+  BoardHeader header;
+  header.title = board->title();
+  header.write( out );
+
+  writeFieldDataRLE( out, board );
+
+  SnapshotTable table;
+  board->fillSnapshotTable( table );
+
+  const AbstractThing *player = table.things.empty() ? 0 : table.things[0];
+
+  // things the loader had no class for go back out as they came in, as
+  // long as what they were attached to is still there
+  std::vector<const UnknownThing*> unknowns;
+  for ( unsigned int i = 0; i < board->unknownThings().size(); i++ ) {
+    const UnknownThing &unknown = board->unknownThings()[i];
+    if ( (int) unknown.bytes.size() < ThingHeader::size ) continue;
+    const ThingHeader header( fileBytes( unknown.bytes ) );
+    const ZZTEntity &entity = board->entity( header.x - 1, header.y - 1 );
+    if ( entity.id() == unknown.id && !entity.thing() ) {
+      unknowns.push_back( &unknown );
+    }
+  }
+
+  // start from what the file had, the shot limit, time limit and the
+  // rest the engine doesn't keep go back out as they came in
+  BoardInformation info( fileBytes( board->fileInfo() ) );
+  if ( board->fileInfo().empty() ) {
+    info.maximumShotsFired = 255;
+    info.enterX = player ? player->xPos() + 1 : 0;
+    info.enterY = player ? player->yPos() + 1 : 0;
+  }
+  info.darkness = board->isDark();
+  info.boardNorth = board->northExit();
+  info.boardSouth = board->southExit();
+  info.boardWest = board->westExit();
+  info.boardEast = board->eastExit();
+  info.message.clear();
+  if ( board->messageLife() > 0 ) {
+    // the board pads it with a space either side for showing
+    const ZString &message = board->message();
+    info.message = ZStringView( message ).sub( 1, message.size() - 2 );
+  }
+  info.thingCount = table.things.size() + unknowns.size() - 1;
+  info.write( out );
+
+  CentipedeLinks links;
+  linkCentipedes( table, links );
+
+  for ( unsigned int i = 0; i < table.things.size(); i++ ) {
+    writeThing( out, table, links, i );
+  }
+  for ( unsigned int i = 0; i < unknowns.size(); i++ ) {
+    out.putBytes( &unknowns[i]->bytes[0], unknowns[i]->bytes.size() );
+  }
+
+  // the size goes in front, so patch it in now that it's known. zzt
+  // reads it as a signed word, anything bigger can't be loaded back.
+  const int sizeInBytes = out.size() - start - 2;
+  if ( sizeInBytes > 0x7fff ) {
+    zwarn() << "WorldWriter: board too big for zzt:" << header.title << sizeInBytes;
+    return false;
+  }
+  bytes[start] = sizeInBytes & 0xff;
+  bytes[start + 1] = ( sizeInBytes >> 8 ) & 0xff;
+  return true;
+}
+
+void WorldWriterPrivate::writeFieldDataRLE( SnapshotWriter &out, GameBoard *board )
+{
+  // one pass in reading order, a run ends on a change or at 255
+  int reps = 0;
+  unsigned char id = 0;
+  unsigned char color = 0;
+
+  for ( int y = 0; y < 25; y++ ) {
+    for ( int x = 0; x < 60; x++ ) {
+      const ZZTEntity &entity = board->entity( x, y );
+      if ( reps > 0 && ( reps == 255 ||
+                         entity.id() != id ||
+                         entity.fileColor() != color ) )
+      {
+        out.putByte( reps );
+        out.putByte( id );
+        out.putByte( color );
+        reps = 0;
+      }
+      id = entity.id();
+      color = entity.fileColor();
+      reps += 1;
+    }
+  }
+
+  out.putByte( reps );
+  out.putByte( id );
+  out.putByte( color );
+}
+
+void WorldWriterPrivate::writeThing( SnapshotWriter &out, const SnapshotTable &table,
+                                     const CentipedeLinks &links, int index )
+{
+  const AbstractThing *thing = table.things[index];
+
+  ThingHeader header( fileBytes( thing->fileHeader() ) );
+  fillThingHeader( header, thing );
+
+  CentipedeLinks::const_iterator link = links.find( thing );
+  if ( link != links.end() ) {
+    header.param4 = link->second;
+  }
+
+  // only scripts have programs, and the loader skipped any others had
+  const signed short fileLength = header.programLength;
+  header.programLength = 0;
+
+  // a program shared by several things gets written once, by the first
+  // of them, and the rest bind to it with a negative index
+  const ZZTOOP::ProgramBank *bank = 0;
+  const ScriptableThing *script = dynamic_cast<const ScriptableThing*>( thing );
+  if ( script && script->interpreter() ) {
+    header.currentInstruction = script->instructionPointer();
+
+    int owner = index;
+    for ( int i = 0; i < index; i++ ) {
+      const ScriptableThing *other = dynamic_cast<const ScriptableThing*>( table.things[i] );
+      if ( other && other->interpreter() == script->interpreter() ) {
+        owner = i;
+        break;
+      }
+    }
+
+    if ( owner == index ) {
+      bank = &script->interpreter()->programBank();
+      header.programLength = bank->size();
+      // the loader doesn't follow a binding from the file, so the thing
+      // comes in with no program of its own. Keep the binding it had.
+      if ( bank->empty() && fileLength < 0 ) {
+        header.programLength = fileLength;
+      }
+    }
+    else {
+      header.programLength = -owner;
+    }
+  }
+
+  header.write( out );
+  if ( bank && !bank->empty() ) {
+    out.putBytes( &(*bank)[0], bank->size() );
+  }
+}
+
+void WorldWriterPrivate::fillThingHeader( ThingHeader &header, const AbstractThing *thing )
+{
+  header.x = thing->xPos() + 1;
+  header.y = thing->yPos() + 1;
+  header.cycle = thing->cycle();
+  header.underTile = thing->underEntity().id();
+  header.underColor = thing->underEntity().fileColor();
+
+  if ( thing->fileHeader().empty() ) {
+    // no leader or follower
+    header.param4 = 0xffffffff;
+  }
+
+  // the reverse of ThingFactory, what it reads in gets written over the
+  // header from the file, and the rest of that goes back out untouched
+  switch ( thing->entityID() )
+  {
+    case ZZTEntity::Passage:
+      header.param3 = static_cast<const Passage*>( thing )->destination();
+      break;
+
+    case ZZTEntity::Bear:
+      header.param1 = static_cast<const Bear*>( thing )->sensativity();
+      break;
+
+    case ZZTEntity::Ruffian:
+      header.param1 = static_cast<const Ruffian*>( thing )->intelligence();
+      header.param2 = static_cast<const Ruffian*>( thing )->rest();
+      break;
+
+    case ZZTEntity::Object:
+      header.param1 = thing->tile();
+      break;
+
+    case ZZTEntity::Slime:
+      header.param2 = static_cast<const Slime*>( thing )->speed();
+      break;
+
+    case ZZTEntity::Shark:
+      header.param1 = static_cast<const Shark*>( thing )->intelligence();
+      break;
+
+    case ZZTEntity::Lion:
+      header.param1 = static_cast<const Lion*>( thing )->intelligence();
+      break;
+
+    case ZZTEntity::Tiger:
+      header.param1 = static_cast<const Tiger*>( thing )->intelligence();
+      break;
+
+    case ZZTEntity::CentipedeHead:
+      header.param1 = static_cast<const CentipedeHead*>( thing )->intelligence();
+      header.param2 = static_cast<const CentipedeHead*>( thing )->deviance();
+      break;
+
+    case ZZTEntity::Bullet: {
+      const Bullet *bullet = static_cast<const Bullet*>( thing );
+      header.param1 = bullet->playerType() ? 0 : 1;
+      header.x_step = 0;
+      header.y_step = 0;
+      switch ( bullet->direction() ) {
+        case North: header.y_step = -1; break;
+        case South: header.y_step = 1; break;
+        case West: header.x_step = -1; break;
+        case East: header.x_step = 1; break;
+        default: break;
+      }
+      break;
+    }
+
+    default: break;
+  }
+}
+
+void WorldWriterPrivate::linkCentipedes( const SnapshotTable &table, CentipedeLinks &links )
+{
+  // links are thing indices, follower in the low word and leader in the
+  // high one. A head that hasn't found its segments yet leaves them with
+  // the links they had in the file.
+  for ( unsigned int i = 0; i < table.things.size(); i++ ) {
+    if ( table.things[i]->entityID() != ZZTEntity::CentipedeHead ) continue;
+    const CentipedeHead *head = static_cast<const CentipedeHead*>( table.things[i] );
+    if ( head->body().empty() ) continue;
+
+    std::vector<const AbstractThing*> chain( 1, head );
+    chain.insert( chain.end(), head->body().begin(), head->body().end() );
+
+    for ( unsigned int k = 0; k < chain.size(); k++ ) {
+      const int leader = ( k > 0 ) ? table.thingIndex( chain[k-1] ) : -1;
+      const int follower = ( k + 1 < chain.size() ) ? table.thingIndex( chain[k+1] ) : -1;
+      links[ chain[k] ] = ( follower & 0xffff ) | ( ( leader & 0xffff ) << 16 );
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+WorldWriter::WorldWriter()
+  : d( new WorldWriterPrivate(this) )
+{
+  /* */
+}
+
+WorldWriter::~WorldWriter()
+{
+  delete d;
+  d = 0;
+}
+
+void WorldWriter::setWorld( GameWorld *world )
+{
+  d->world = world;
+}
+
+void WorldWriter::setSavegame( bool savegame )
+{
+  d->savegame = savegame;
+}
+
+bool WorldWriter::write( std::vector<unsigned char> &out )
+{
+  const unsigned int start = out.size();
+  SnapshotWriter writer( out );
+  if ( !d->writeWorldHeader( writer ) ) {
+    return false;
+  }
+
+  // every board goes straight into the one buffer
+  for ( int x = 0; x < d->world->maxBoards(); x++ ) {
+    if ( !d->writeBoard( out, d->world->getBoard( x ) ) ) {
+      out.resize( start );
+      return false;
+    }
+  }
+  return true;
+}
+
+bool WorldWriter::go( const ZString &filename )
+{
+  if ( !d->world ) {
+    return false;
+  }
+
+  std::vector<unsigned char> bytes;
+  if ( !write( bytes ) ) {
+    return false;
+  }
+
+  std::ofstream file( filename.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+  if ( !file.is_open() ) {
+    zwarn() << "WorldWriter: couldn't write" << filename;
+    return false;
+  }
+  file.write( (const char *) &bytes[0], bytes.size() );
+  return file.good();
+}
+
+// ---------------------------------------------------------------------------
+
+bool WorldWriter::saveWorld( GameWorld *world, const ZString &filename,
+                             bool savegame )
+{
+  WorldWriter writer;
+  writer.setWorld( world );
+  writer.setSavegame( savegame );
+  return writer.go( filename );
+}
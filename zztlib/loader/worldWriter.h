@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef WORLD_WRITER_H
+#define WORLD_WRITER_H
+
+#include <vector>
+
+class ZString;
+class GameWorld;
+class WorldWriterPrivate;
+
+/// Writes a GameWorld back out as a version 3.2 zzt world file,
+/// the reverse of WorldLoader.
+class WorldWriter
+{
+  public:
+    WorldWriter();
+    ~WorldWriter();
+
+    /// provide GameWorld object to write out
+    void setWorld( GameWorld *world );
+
+    /// a saved game starts on the current board, and is flagged as such
+    void setSavegame( bool savegame );
+
+    /// encodes the whole world onto the end of out. False, with out left
+    /// as it was, if it has gaps or a board too big for zzt to load.
+    bool write( std::vector<unsigned char> &out );
+
+    /// Does the deed of writing the world file
+    bool go( const ZString &filename );
+
+    /// Convienience function to write a world in one go
+    static bool saveWorld( GameWorld *world, const ZString &filename,
+                           bool savegame = false );
+
+  private:
+    WorldWriterPrivate *d;
+
+    /// disabled copy constructor
+    WorldWriter(const WorldWriter &);
+    /// disabled assignment operator
+    WorldWriter & operator=(const WorldWriter &);
+};
+
+#endif // WORLD_WRITER_H
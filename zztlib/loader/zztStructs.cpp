@@ -1,116 +1,228 @@
 
 #include <string>
+#include <vector>
 #include "zstring.h"
+#include "snapshotStream.h"
 #include "zztStructs.h"
 
 // ---------------------------------------------------------------------------
-// utility functions, define as needed for platform endianness
+// zzt files are little endian, put together a byte at a time so neither
+// host endianness nor alignment matter
 
-// zzt binary to little endian
-unsigned char zztByte( const unsigned char *data )
+ZZTReader ZZTReader::window( int offset, int length ) const
 {
-  return *data;
+  if ( !fits( offset, length ) ) return ZZTReader( 0, 0 );
+  return ZZTReader( m_data + offset, length );
 }
 
-// zzt binary to little endian
-signed short zztWord( const unsigned char *data )
+signed short ZZTReader::word( int offset ) const
 {
-  return *(reinterpret_cast<const signed short*>(data));
+  if ( !fits( offset, 2 ) ) return 0;
+  const unsigned char *p = m_data + offset;
+  return (signed short) ( p[0] | ( p[1] << 8 ) );
 }
 
-// zzt binary to little endian
-unsigned long zztLong( const unsigned char *data )
+unsigned int ZZTReader::dword( int offset ) const
 {
-  return *(reinterpret_cast<const unsigned int*>(data));
+  if ( !fits( offset, 4 ) ) return 0;
+  const unsigned char *p = m_data + offset;
+  return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int) p[3] << 24 );
 }
 
-// zzt binary to little endian
-ZString zztString( const unsigned char *data )
+ZStringView ZZTReader::string( int offset, int capacity ) const
 {
-  int len = *data;
-  if (len > 127) len = 127; // minor security detail
-  return ZString( (const char *)(data + 0x01), len );
+  if ( !fits( offset, 1 ) ) return ZStringView();
+  int len = m_data[offset];
+  if ( len > capacity ) len = capacity;
+  if ( len > m_size - offset - 1 ) len = m_size - offset - 1;
+  return ZStringView( (const char *)( m_data + offset + 1 ), len );
+}
+
+// writing goes through SnapshotWriter, which is little endian already
+
+static void putZero( SnapshotWriter &out, int count )
+{
+  for ( int i = 0; i < count; i++ ) {
+    out.putByte( 0 );
+  }
+}
+
+// pascal string padded out to the field's capacity
+static void putString( SnapshotWriter &out, const ZStringView &str, int capacity )
+{
+  const int len = (int) str.size() < capacity ? str.size() : capacity;
+  out.putByte( len );
+  out.putBytes( (const unsigned char *) str.data(), len );
+  putZero( out, capacity - len );
 }
 
 // ---------------------------------------------------------------------------
 // taken mostly from kev's file format
 
-WorldHeader::WorldHeader( const unsigned char *data )
+WorldHeader::WorldHeader( const ZZTReader &data )
+{
+  magicKey = (unsigned short) data.word( 0x00 );
+  boardCount = data.word( 0x02 );
+  ammo = data.word( 0x04 );
+  gems = data.word( 0x06 );
+
+  blueKey = data.byte( 0x08 );
+  greenKey = data.byte( 0x09 );
+  cyanKey = data.byte( 0x0A );
+  redKey = data.byte( 0x0B );
+  purpleKey = data.byte( 0x0C );
+  yellowKey = data.byte( 0x0D );
+  whiteKey = data.byte( 0x0E );
+
+  health = data.word( 0x0F );
+  startBoard = data.word( 0x11 );
+  torches = data.word( 0x13 );
+  torchCycles = data.word( 0x15 );
+  energizerCycles = data.word( 0x17 );
+  score = data.word( 0x1B );
+
+  gameName = data.string( 0x1D, 20 );
+
+  for ( int x = 0; x < 10; x++ ) {
+    flags[x] = data.string( (x * 21) + 0x32, 20 );
+  }
+
+  time = data.word( 0x104 );
+  savegame = data.byte( 0x108 );
+}
+
+void WorldHeader::write( SnapshotWriter &out ) const
 {
-  magicKey = (unsigned short) zztWord( data + 0x00 );
-  boardCount = zztWord( data + 0x02 );
-  ammo = zztWord( data + 0x04 );
-  gems = zztWord( data + 0x06 );
-
-  blueKey = zztByte( data + 0x08 );
-  greenKey = zztByte( data + 0x09 );
-  cyanKey = zztByte( data + 0x0A );
-  redKey = zztByte( data + 0x0B );
-  purpleKey = zztByte( data + 0x0C );
-  yellowKey = zztByte( data + 0x0D );
-  whiteKey = zztByte( data + 0x0E );
-
-  health = zztWord( data + 0x0F );
-  startBoard = zztWord( data + 0x11 );
-  torches = zztWord( data + 0x13 );
-  torchCycles = zztWord( data + 0x15 );
-  energizerCycles = zztWord( data + 0x17 );
-  score = zztWord( data + 0x1B );
-
-  gameName = zztString( data + 0x1D );
+  const unsigned int start = out.size();
+
+  out.putWord( magicKey );
+  out.putWord( boardCount );
+  out.putWord( ammo );
+  out.putWord( gems );
+
+  out.putByte( blueKey );
+  out.putByte( greenKey );
+  out.putByte( cyanKey );
+  out.putByte( redKey );
+  out.putByte( purpleKey );
+  out.putByte( yellowKey );
+  out.putByte( whiteKey );
+
+  out.putWord( health );
+  out.putWord( startBoard );
+  out.putWord( torches );
+  out.putWord( torchCycles );
+  out.putWord( energizerCycles );
+  putZero( out, 2 );
+  out.putWord( score );
+
+  putString( out, gameName, 20 );
 
   for ( int x = 0; x < 10; x++ ) {
-    flags[x] = zztString( data + (x * 21) + 0x32 );
+    putString( out, flags[x], 20 );
   }
 
-  time = zztWord( data + 0x104 );
-  savegame = zztByte( data + 0x108 );
+  out.putWord( time );
+  putZero( out, 2 );
+  out.putByte( savegame );
+
+  putZero( out, size - ( out.size() - start ) );
 }
 
 // ---------------------------------------------------------------------------
 
-BoardHeader::BoardHeader( const unsigned char *data )
+BoardHeader::BoardHeader( const ZZTReader &data )
+{
+  sizeInBytes = data.word( 0x00 );
+  title = data.string( 0x02, 50 );
+}
+
+int BoardHeader::storedSize( const ZZTReader &data )
+{
+  const int size = data.word( 0x00 );
+  return ( size < 0 ) ? -1 : size + 2;
+}
+
+void BoardHeader::write( SnapshotWriter &out ) const
 {
-  sizeInBytes = zztWord( data );
-  title = zztString( data + 0x02 );
+  out.putWord( sizeInBytes );
+  putString( out, title, 50 );
 }
 
 // ---------------------------------------------------------------------------
 
-BoardInformation::BoardInformation( const unsigned char *data )
+BoardInformation::BoardInformation( const ZZTReader &data )
+{
+  maximumShotsFired = data.byte( 0x00 );
+  darkness = data.byte( 0x01 );
+  boardNorth = data.byte( 0x02 );
+  boardSouth = data.byte( 0x03 );
+  boardWest = data.byte( 0x04 );
+  boardEast = data.byte( 0x05 );
+  reenterZapped = data.byte( 0x06 );
+
+  message = data.string( 0x07, 58 );
+
+  enterX = data.byte( 0x42 );
+  enterY = data.byte( 0x43 );
+  timeLimit = data.word( 0x44 );
+  thingCount = data.word( 0x56 );
+}
+
+void BoardInformation::write( SnapshotWriter &out ) const
 {
-  maximumShotsFired = zztByte( data + 0x00 );
-  darkness = zztByte( data + 0x01 );
-  boardNorth = zztByte( data + 0x02 );
-  boardSouth = zztByte( data + 0x03 );
-  boardWest = zztByte( data + 0x04 );
-  boardEast = zztByte( data + 0x05 );
-  reenterZapped = zztByte( data + 0x06 );
-
-  message = zztString( data + 0x07 );
-
-  enterX = zztByte( data + 0x42 );
-  enterY = zztByte( data + 0x43 );
-  timeLimit = zztWord( data + 0x44 );
-  thingCount = zztWord( data + 0x56 );
+  out.putByte( maximumShotsFired );
+  out.putByte( darkness );
+  out.putByte( boardNorth );
+  out.putByte( boardSouth );
+  out.putByte( boardWest );
+  out.putByte( boardEast );
+  out.putByte( reenterZapped );
+
+  putString( out, message, 58 );
+
+  out.putByte( enterX );
+  out.putByte( enterY );
+  out.putWord( timeLimit );
+  putZero( out, 16 );
+  out.putWord( thingCount );
 }
 
 // ---------------------------------------------------------------------------
 
-ThingHeader::ThingHeader( const unsigned char *data )
+ThingHeader::ThingHeader( const ZZTReader &data )
+{
+  x = data.byte( 0x00 );
+  y = data.byte( 0x01 );
+  x_step = data.word( 0x02 );
+  y_step = data.word( 0x04 );
+  cycle = data.word( 0x06 );
+  param1 = data.byte( 0x08 );
+  param2 = data.byte( 0x09 );
+  param3 = data.byte( 0x0A );
+  param4 = data.dword( 0x0B );
+  underTile = data.byte( 0x0F );
+  underColor = data.byte( 0x10 );
+  currentInstruction = data.word( 0x15 );
+  programLength = data.word( 0x17 );
+}
+
+void ThingHeader::write( SnapshotWriter &out ) const
 {
-  x = zztByte( data + 0x00 );
-  y = zztByte( data + 0x01 );
-  x_step = zztWord( data + 0x02 );
-  y_step = zztWord( data + 0x04 );
-  cycle = zztWord( data + 0x06 );
-  param1 = zztByte( data + 0x08 );
-  param2 = zztByte( data + 0x09 );
-  param3 = zztByte( data + 0x0A );
-  param4 = zztLong( data + 0x0B );
-  underTile = zztByte( data + 0x0F );
-  underColor = zztByte( data + 0x10 );
-  currentInstruction = zztWord( data + 0x15 );
-  programLength = zztWord( data + 0x17 );
+  out.putByte( x );
+  out.putByte( y );
+  out.putWord( x_step );
+  out.putWord( y_step );
+  out.putWord( cycle );
+  out.putByte( param1 );
+  out.putByte( param2 );
+  out.putByte( param3 );
+  out.putDWord( param4 );
+  out.putByte( underTile );
+  out.putByte( underColor );
+  putZero( out, 4 );
+  out.putWord( currentInstruction );
+  out.putWord( programLength );
+  putZero( out, 8 );
 }
 
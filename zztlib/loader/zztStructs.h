@@ -8,9 +8,54 @@
 #ifndef ZZT_STRUCTS_H
 #define ZZT_STRUCTS_H
 
+#include "zfixedString.h"
+
+class SnapshotWriter;
+
+/// Bounds checked view onto part of a zzt file. Reads from outside the
+/// view come back as zeros, so a struct can be read without checking
+/// every field, and the loader only has to ask fits() once per struct.
+class ZZTReader
+{
+  public:
+    ZZTReader( const unsigned char *data, int size )
+      : m_data(data), m_size( data && size > 0 ? size : 0 ) { /* */ };
+
+    /// length bytes at offset are all inside the view
+    bool fits( int offset, int length ) const
+    {
+      return offset >= 0 && length >= 0 && offset <= m_size - length;
+    };
+
+    /// narrower view, empty when it doesn't fit
+    ZZTReader window( int offset, int length ) const;
+
+    const unsigned char *data() const { return m_data; };
+    int size() const { return m_size; };
+
+    unsigned char byte( int offset ) const
+    {
+      return fits( offset, 1 ) ? m_data[offset] : 0;
+    };
+    signed short word( int offset ) const;
+    unsigned int dword( int offset ) const;
+    /// pascal string, cut to the field's capacity and to the view.
+    /// points into the data, so copy it out before the data goes away.
+    ZStringView string( int offset, int capacity ) const;
+
+  private:
+    const unsigned char *m_data;
+    int m_size;
+};
+
 struct WorldHeader
 {
-  WorldHeader( const unsigned char *data );
+  /// the default empty reader leaves every field zeroed, for writing
+  WorldHeader( const ZZTReader &data = ZZTReader( 0, 0 ) );
+  /// writes all size bytes back out
+  void write( SnapshotWriter &out ) const;
+  /// boards start right after
+  static const int size = 0x200;
 
   unsigned short magicKey; // FFFFh
   signed short boardCount; // minus 1, so 0x0 is 1, 0x1 is 2, etc.
@@ -29,23 +74,32 @@ struct WorldHeader
   signed short torchCycles;
   signed short energizerCycles;
   signed short score;
-  ZString gameName;
-  ZString flags[10];
+  ZFixedString<20> gameName;
+  ZFixedString<20> flags[10];
   unsigned short time;
   unsigned char savegame;
 };
 
 struct BoardHeader
 {
-  BoardHeader( const unsigned char *data );
+  BoardHeader( const ZZTReader &data = ZZTReader( 0, 0 ) );
+  void write( SnapshotWriter &out ) const;
+  /// the field starts right after, sizeInBytes counts from after itself
+  static const int size = 0x35;
+
+  /// bytes the board at the start of data takes up, size word included.
+  /// zzt keeps the size in a signed word, so -1 when it's negative.
+  static int storedSize( const ZZTReader &data );
 
   signed short sizeInBytes;
-  ZString title;
+  ZFixedString<50> title;
 };
 
 struct BoardInformation
 {
-  BoardInformation( const unsigned char *data );
+  BoardInformation( const ZZTReader &data = ZZTReader( 0, 0 ) );
+  void write( SnapshotWriter &out ) const;
+  static const int size = 0x58;
 
   unsigned char maximumShotsFired;
   unsigned char darkness;
@@ -54,7 +108,7 @@ struct BoardInformation
   unsigned char boardWest;
   unsigned char boardEast;
   unsigned char reenterZapped;
-  ZString message;
+  ZFixedString<58> message;
   unsigned char enterX;
   unsigned char enterY;
   signed short timeLimit;
@@ -63,7 +117,11 @@ struct BoardInformation
 
 struct ThingHeader
 {
-  ThingHeader( const unsigned char *data );
+  ThingHeader( const ZZTReader &data = ZZTReader( 0, 0 ) );
+  /// writes the header only, the program is up to the caller
+  void write( SnapshotWriter &out ) const;
+  /// the program follows, when programLength is positive
+  static const int size = 0x21;
 
   unsigned char x;
   unsigned char y;
@@ -80,10 +138,5 @@ struct ThingHeader
   signed short programLength;
 };
 
-unsigned char zztByte( const unsigned char *data );
-signed short zztWord( const unsigned char *data );
-signed short zztWord( const unsigned char *data );
-ZString zztString( const unsigned char *data );
-
 #endif // ZZT_STRUCTS_H
 
@@ -0,0 +1,23 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef NULL_PAINTER_H
+#define NULL_PAINTER_H
+
+#include "abstractPainter.h"
+
+/// swallows everything, for running worlds with nobody watching
+class NullPainter : public AbstractPainter
+{
+  public:
+    virtual void paintChar( int x, int y, unsigned char c, unsigned char color ) { /* */ };
+
+  protected:
+    virtual int currentTime() { return 0; };
+};
+
+#endif // NULL_PAINTER_H
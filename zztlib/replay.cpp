@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <fstream>
+#include <vector>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "randomizer.h"
+#include "snapshotStream.h"
+#include "worldSnapshot.h"
+#include "replay.h"
+
+static const char replayMagic[] = "FZRP";
+static const int replayVersion = 2;
+
+static const unsigned int FNV_OFFSET = 2166136261u;
+static const unsigned int FNV_PRIME = 16777619u;
+
+static unsigned int fnvHash( unsigned int hash, const unsigned char *data,
+                             unsigned int length )
+{
+  for ( unsigned int i = 0; i < length; i++ ) {
+    hash ^= data[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+// ---------------------------------------------------------------------------
+
+ReplayFile::ReplayFile()
+  : seed( 0 )
+{
+  /* */
+}
+
+unsigned int ReplayFile::hashWorld( GameWorld *world )
+{
+  WorldSnapshot snapshot;
+  world->saveSnapshot( snapshot );
+
+  unsigned int hash = fnvHash( FNV_OFFSET, snapshot.worldState.data(),
+                               snapshot.worldState.size() );
+
+  const unsigned int index = world->currentIndex();
+  if ( index < snapshot.boards.size() ) {
+    const SnapshotBlob &board = snapshot.boards[index];
+    hash = fnvHash( hash, board.data(), board.size() );
+  }
+  return hash;
+}
+
+bool ReplayFile::save( const ZString &filename ) const
+{
+  SnapshotBytes bytes;
+  SnapshotWriter out( bytes );
+  out.putBytes( (const unsigned char *) replayMagic, 4 );
+  out.putWord( replayVersion );
+  out.putDWord( seed );
+
+  SnapshotBytes startBytes;
+  start.serialize( startBytes );
+  out.putDWord( startBytes.size() );
+  out.putBytes( &startBytes[0], startBytes.size() );
+
+  out.putDWord( ticks.size() );
+  for ( unsigned int i = 0; i < ticks.size(); i++ ) {
+    const ReplayTick &tick = ticks[i];
+    out.putWord( tick.keys.size() );
+    for ( unsigned int k = 0; k < tick.keys.size(); k++ ) {
+      out.putByte( tick.keys[k].keycode );
+      out.putWord( tick.keys[k].unicode );
+    }
+    out.putDWord( tick.hash );
+  }
+
+  std::ofstream file( filename.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+  if ( !file.is_open() ) {
+    zwarn() << "ReplayFile: couldn't write" << filename;
+    return false;
+  }
+  file.write( (const char *) &bytes[0], bytes.size() );
+  return file.good();
+}
+
+bool ReplayFile::load( const ZString &filename )
+{
+  using namespace std;
+
+  ticks.clear();
+  start.clear();
+
+  ifstream file( filename.c_str(), ios::in|ios::binary|ios::ate );
+  if ( !file.is_open() || !file.good() ) {
+    zwarn() << "ReplayFile: couldn't read" << filename;
+    return false;
+  }
+  SnapshotBytes bytes( file.tellg() );
+  file.seekg( 0, ios::beg );
+  if ( !bytes.empty() ) {
+    file.read( (char *) &bytes[0], bytes.size() );
+  }
+
+  SnapshotReader in( bytes.empty() ? 0 : &bytes[0], bytes.size() );
+  const unsigned char *magic = in.getBytes( 4 );
+  if ( !magic || ZString( (const char *) magic, 4 ) != replayMagic ||
+       in.getWord() != replayVersion ) {
+    zwarn() << "ReplayFile: not a replay" << filename;
+    return false;
+  }
+  seed = in.getDWord();
+
+  const unsigned int startLength = in.getDWord();
+  const unsigned char *startBytes = in.getBytes( startLength );
+  if ( !startBytes || !start.deserialize( startBytes, startLength ) ) {
+    zwarn() << "ReplayFile: bad starting snapshot" << filename;
+    return false;
+  }
+
+  const unsigned int tickCount = in.getDWord();
+  for ( unsigned int i = 0; i < tickCount && in.ok(); i++ ) {
+    ReplayTick tick;
+    const int keyCount = in.getWord();
+    for ( int k = 0; k < keyCount && in.ok(); k++ ) {
+      ReplayKey key;
+      key.keycode = in.getByte();
+      key.unicode = in.getWord();
+      tick.keys.push_back( key );
+    }
+    tick.hash = in.getDWord();
+    ticks.push_back( tick );
+  }
+
+  if ( !in.ok() ) {
+    zwarn() << "ReplayFile: truncated" << filename;
+    ticks.clear();
+    return false;
+  }
+
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+ReplayRecorder::ReplayRecorder()
+  : m_world( 0 )
+{
+  m_pending.hash = 0;
+}
+
+void ReplayRecorder::begin( GameWorld *world, unsigned int seed )
+{
+  world->randomizer().seed( seed );
+
+  m_replay = ReplayFile();
+  m_replay.seed = seed;
+  world->saveSnapshot( m_replay.start );
+
+  m_pending = ReplayTick();
+  m_pending.hash = 0;
+
+  m_world = world;
+  m_world->setReplayRecorder( this );
+  zinfo() << "ReplayRecorder::begin" << seed;
+}
+
+bool ReplayRecorder::end( const ZString &filename )
+{
+  if ( !m_world ) {
+    return false;
+  }
+
+  m_world->setReplayRecorder( 0 );
+  m_world = 0;
+
+  zinfo() << "ReplayRecorder::end" << m_replay.ticks.size() << "ticks";
+  return m_replay.save( filename );
+}
+
+void ReplayRecorder::addKey( int keycode, int unicode )
+{
+  ReplayKey key;
+  key.keycode = keycode;
+  key.unicode = unicode;
+  m_pending.keys.push_back( key );
+}
+
+void ReplayRecorder::endCycle()
+{
+  m_pending.hash = ReplayFile::hashWorld( m_world );
+  m_replay.ticks.push_back( m_pending );
+
+  m_pending.keys.clear();
+}
+
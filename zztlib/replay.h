@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <vector>
+#include "zstring.h"
+#include "worldSnapshot.h"
+
+class GameWorld;
+
+/// one key handed to GameWorld::addInputKey
+struct ReplayKey
+{
+  int keycode;
+  int unicode;
+};
+
+/// everything that went into one world cycle, and what came out
+struct ReplayTick
+{
+  std::vector<ReplayKey> keys;
+  /// ReplayFile::hashWorld after the cycle
+  unsigned int hash;
+};
+
+/// A recorded play session: the world as it was when recording started,
+/// then the input and resulting state hash of every cycle after.
+class ReplayFile
+{
+  public:
+    ReplayFile();
+
+    bool save( const ZString &filename ) const;
+    bool load( const ZString &filename );
+
+    /// FNV-1a of the world counters and the current board
+    static unsigned int hashWorld( GameWorld *world );
+
+  public:
+    unsigned int seed;
+    WorldSnapshot start;
+    std::vector<ReplayTick> ticks;
+};
+
+/// Collects a ReplayFile while attached to a GameWorld.
+class ReplayRecorder
+{
+  public:
+    ReplayRecorder();
+
+    /// seeds the randomizer, snapshots the world and attaches to it
+    void begin( GameWorld *world, unsigned int seed );
+    /// detaches and writes the replay out
+    bool end( const ZString &filename );
+    /// accessor
+    bool isRecording() const { return m_world != 0; };
+
+    /// called by the world
+    void addKey( int keycode, int unicode );
+    /// called by the world after each cycle
+    void endCycle();
+
+    /// accessor
+    const ReplayFile &replay() const { return m_replay; };
+
+  private:
+    GameWorld *m_world;
+    ReplayFile m_replay;
+    ReplayTick m_pending;
+};
+
+#endif // REPLAY_H
+
@@ -0,0 +1,377 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "snapshotStream.h"
+#include "worldSnapshot.h"
+#include "rewindBuffer.h"
+
+// changes closer together than this are sent as one run
+static const unsigned int MERGE_GAP = 8;
+static const unsigned int MAX_RUN = 0xFFFF;
+
+/// byte changes needed to turn one board blob into the next
+struct BoardDelta
+{
+  int board;
+  SnapshotBlob patch;
+};
+
+/// one recorded cycle
+struct RewindFrame
+{
+  bool keyframe;
+  /// keyframes only
+  WorldSnapshot snapshot;
+  /// everything else
+  SnapshotBlob worldState;
+  std::vector<BoardDelta> deltas;
+  int boardCount;
+  /// memory this frame adds, not counting blobs an older frame holds
+  unsigned int bytes;
+};
+
+typedef std::deque<RewindFrame> FrameRing;
+
+// ---------------------------------------------------------------------------
+
+static void putRun( SnapshotWriter &out, const unsigned char *data,
+                    unsigned int offset, unsigned int length )
+{
+  while ( length > 0 ) {
+    const unsigned int chunk = ( length > MAX_RUN ) ? MAX_RUN : length;
+    out.putDWord( offset );
+    out.putWord( chunk );
+    out.putBytes( data + offset, chunk );
+    offset += chunk;
+    length -= chunk;
+  }
+}
+
+/// encodes the runs of bytes that differ between two blobs
+static SnapshotBlob makePatch( const SnapshotBlob &from, const SnapshotBlob &to )
+{
+  SnapshotBytes bytes;
+  SnapshotWriter out( bytes );
+
+  const unsigned char *oldData = from.data();
+  const unsigned char *newData = to.data();
+  const unsigned int oldSize = from.size();
+  const unsigned int newSize = to.size();
+  const unsigned int common = ( oldSize < newSize ) ? oldSize : newSize;
+
+  out.putDWord( newSize );
+
+  unsigned int i = 0;
+  while ( i < common ) {
+    if ( oldData[i] == newData[i] ) {
+      i++;
+      continue;
+    }
+
+    // extend the run until a long enough stretch matches again
+    const unsigned int start = i;
+    unsigned int end = i + 1;
+    unsigned int same = 0;
+    for ( i = end; i < common && same < MERGE_GAP; i++ ) {
+      if ( oldData[i] == newData[i] ) {
+        same++;
+      }
+      else {
+        same = 0;
+        end = i + 1;
+      }
+    }
+    putRun( out, newData, start, end - start );
+    i = end;
+  }
+
+  if ( newSize > common ) {
+    putRun( out, newData, common, newSize - common );
+  }
+
+  return SnapshotBlob( bytes );
+}
+
+/// applies what makePatch made
+static SnapshotBlob applyPatch( const SnapshotBlob &from, const SnapshotBlob &patch )
+{
+  SnapshotReader in( patch.data(), patch.size() );
+  const unsigned int newSize = in.getDWord();
+
+  SnapshotBytes bytes( from.data(), from.data() + from.size() );
+  bytes.resize( newSize );
+
+  while ( in.ok() && !in.atEnd() ) {
+    const unsigned int offset = in.getDWord();
+    const unsigned int length = in.getWord();
+    const unsigned char *data = in.getBytes( length );
+    if ( !data || offset + length > newSize ) {
+      zwarn() << "RewindBuffer: bad patch";
+      return SnapshotBlob();
+    }
+    std::copy( data, data + length, bytes.begin() + offset );
+  }
+
+  return SnapshotBlob( bytes );
+}
+
+// ---------------------------------------------------------------------------
+
+class RewindBufferPrivate
+{
+  public:
+    RewindBufferPrivate( RewindBuffer *pSelf );
+    virtual ~RewindBufferPrivate();
+
+    void addFrame( const WorldSnapshot &snapshot );
+    void trim();
+    bool rebuild( int index, WorldSnapshot &snapshot ) const;
+
+  public:
+    FrameRing frames;
+    /// what the newest frame decodes to
+    WorldSnapshot last;
+    unsigned int memoryLimit;
+    unsigned int memoryUsed;
+    int keyframeInterval;
+    int sinceKeyframe;
+    int keyframes;
+
+  private:
+    RewindBuffer *self;
+};
+
+RewindBufferPrivate::RewindBufferPrivate( RewindBuffer *pSelf )
+  : memoryLimit( 4 * 1024 * 1024 ),
+    memoryUsed( 0 ),
+    keyframeInterval( 60 ),
+    sinceKeyframe( 0 ),
+    keyframes( 0 ),
+    self( pSelf )
+{
+  /* */
+}
+
+RewindBufferPrivate::~RewindBufferPrivate()
+{
+  self = 0;
+}
+
+void RewindBufferPrivate::addFrame( const WorldSnapshot &snapshot )
+{
+  frames.push_back( RewindFrame() );
+  RewindFrame &frame = frames.back();
+
+  // start a keyframe when one's due, or when the only one left is
+  // holding back the memory cap.
+  const bool overLimit = ( memoryUsed > memoryLimit && keyframes <= 1 );
+  frame.keyframe = ( frames.size() == 1 ||
+                     sinceKeyframe >= keyframeInterval ||
+                     overLimit );
+
+  if ( frame.keyframe ) {
+    frame.snapshot = snapshot;
+    frame.bytes = snapshot.worldState.size();
+    // boards that haven't changed since the keyframe before are the same
+    // shared blobs, and only cost memory once.
+    const RewindFrame *previous = 0;
+    for ( int i = frames.size() - 2; i >= 0 && !previous; i-- ) {
+      if ( frames[i].keyframe ) previous = &frames[i];
+    }
+    for ( unsigned int i = 0; i < snapshot.boards.size(); i++ ) {
+      const SnapshotBlob &board = snapshot.boards[i];
+      if ( previous && i < previous->snapshot.boards.size() &&
+           board.sameAs( previous->snapshot.boards[i] ) ) {
+        continue;
+      }
+      frame.bytes += board.size();
+    }
+    frame.boardCount = snapshot.boards.size();
+    keyframes += 1;
+    sinceKeyframe = 0;
+  }
+  else {
+    frame.worldState = snapshot.worldState;
+    frame.boardCount = snapshot.boards.size();
+    frame.bytes = frame.worldState.size();
+    for ( unsigned int i = 0; i < snapshot.boards.size(); i++ ) {
+      const SnapshotBlob &board = snapshot.boards[i];
+      const SnapshotBlob previous = ( i < last.boards.size() ) ? last.boards[i]
+                                                                : SnapshotBlob();
+      if ( board.sameAs( previous ) ) {
+        continue;
+      }
+      BoardDelta delta;
+      delta.board = i;
+      delta.patch = makePatch( previous, board );
+      frame.bytes += delta.patch.size();
+      frame.deltas.push_back( delta );
+    }
+    sinceKeyframe += 1;
+  }
+
+  memoryUsed += frame.bytes;
+  last = snapshot;
+}
+
+void RewindBufferPrivate::trim()
+{
+  // drop whole keyframe groups from the front, never the newest one
+  while ( memoryUsed > memoryLimit && keyframes > 1 ) {
+    do {
+      memoryUsed -= frames.front().bytes;
+      frames.pop_front();
+    } while ( !frames.front().keyframe );
+    keyframes -= 1;
+
+    // the new oldest keyframe is now the only holder of the boards it
+    // shared with the one dropped, so it pays for all of them.
+    RewindFrame &oldest = frames.front();
+    const unsigned int full = oldest.snapshot.size();
+    memoryUsed += full - oldest.bytes;
+    oldest.bytes = full;
+  }
+}
+
+bool RewindBufferPrivate::rebuild( int index, WorldSnapshot &snapshot ) const
+{
+  int key = index;
+  while ( key > 0 && !frames[key].keyframe ) {
+    key--;
+  }
+  if ( !frames[key].keyframe ) {
+    return false;
+  }
+
+  snapshot = frames[key].snapshot;
+  for ( int i = key + 1; i <= index; i++ ) {
+    const RewindFrame &frame = frames[i];
+    snapshot.worldState = frame.worldState;
+    snapshot.boards.resize( frame.boardCount );
+    for ( unsigned int j = 0; j < frame.deltas.size(); j++ ) {
+      const BoardDelta &delta = frame.deltas[j];
+      SnapshotBlob &board = snapshot.boards[delta.board];
+      board = applyPatch( board, delta.patch );
+      if ( board.isNull() ) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+RewindBuffer::RewindBuffer()
+  : d( new RewindBufferPrivate(this) )
+{
+  /* */
+}
+
+RewindBuffer::~RewindBuffer()
+{
+  delete d;
+  d = 0;
+}
+
+void RewindBuffer::setMemoryLimit( unsigned int bytes )
+{
+  d->memoryLimit = bytes;
+  if ( bytes == 0 ) {
+    clear();
+  }
+  else {
+    d->trim();
+  }
+}
+
+unsigned int RewindBuffer::memoryLimit() const
+{
+  return d->memoryLimit;
+}
+
+void RewindBuffer::setKeyframeInterval( int cycles )
+{
+  d->keyframeInterval = ( cycles < 1 ) ? 1 : cycles;
+}
+
+int RewindBuffer::keyframeInterval() const
+{
+  return d->keyframeInterval;
+}
+
+void RewindBuffer::clear()
+{
+  d->frames.clear();
+  d->last.clear();
+  d->memoryUsed = 0;
+  d->sinceKeyframe = 0;
+  d->keyframes = 0;
+}
+
+void RewindBuffer::record( GameWorld *world )
+{
+  if ( d->memoryLimit == 0 ) {
+    return;
+  }
+
+  WorldSnapshot snapshot;
+  world->saveSnapshot( snapshot );
+  d->addFrame( snapshot );
+  d->trim();
+}
+
+bool RewindBuffer::stepBack( GameWorld *world )
+{
+  // the newest frame is where the world already is
+  if ( d->frames.size() < 2 ) {
+    return false;
+  }
+
+  WorldSnapshot snapshot;
+  if ( !d->rebuild( d->frames.size() - 2, snapshot ) ||
+       !world->restoreSnapshot( snapshot ) ) {
+    zwarn() << "RewindBuffer::stepBack failed";
+    clear();
+    return false;
+  }
+
+  RewindFrame &dropped = d->frames.back();
+  d->memoryUsed -= dropped.bytes;
+  if ( dropped.keyframe ) {
+    d->keyframes -= 1;
+  }
+  d->frames.pop_back();
+
+  // pick up counting from the frame we're back on
+  d->sinceKeyframe = 0;
+  for ( int i = d->frames.size() - 1; i > 0 && !d->frames[i].keyframe; i-- ) {
+    d->sinceKeyframe += 1;
+  }
+
+  d->last = snapshot;
+  return true;
+}
+
+int RewindBuffer::depth() const
+{
+  return d->frames.empty() ? 0 : d->frames.size() - 1;
+}
+
+unsigned int RewindBuffer::memoryUsed() const
+{
+  return d->memoryUsed;
+}
+
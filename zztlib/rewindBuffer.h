@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+class GameWorld;
+class RewindBufferPrivate;
+
+/// Keeps the last few thousand world cycles so play can be stepped
+/// backwards. Every so many cycles a full snapshot is kept as a keyframe,
+/// the cycles in between only hold the bytes that changed.
+class RewindBuffer
+{
+  public:
+    RewindBuffer();
+    virtual ~RewindBuffer();
+
+    /// oldest cycles are dropped past this many bytes, 0 turns recording off
+    void setMemoryLimit( unsigned int bytes );
+    /// accessor
+    unsigned int memoryLimit() const;
+
+    /// cycles between full snapshots
+    void setKeyframeInterval( int cycles );
+    /// accessor
+    int keyframeInterval() const;
+
+    /// forgets everything recorded
+    void clear();
+
+    /// records the world as it is after a cycle
+    void record( GameWorld *world );
+
+    /// puts the world back one cycle. false if there's nothing left.
+    bool stepBack( GameWorld *world );
+
+    /// how many cycles can be stepped back
+    int depth() const;
+    /// bytes held right now
+    unsigned int memoryUsed() const;
+
+  private:
+    RewindBufferPrivate *d;
+};
+
+#endif // REWIND_BUFFER_H
+
@@ -19,6 +19,8 @@ class AbstractScrollModel
       Close
     };
 
+    virtual ~AbstractScrollModel() { /* */ };
+
     virtual ZString getTitleMessage() const = 0;
     virtual ZString getLineMessage( int line ) const = 0;
     virtual ZString getLineData( int line ) const = 0;
@@ -26,6 +28,9 @@ class AbstractScrollModel
     virtual bool isHighlighted( int line ) const = 0;
     virtual Action getAction( int line ) const = 0;
     virtual int lineCount() const = 0;
+
+    /// polled every frame, true when the lines changed since last time
+    virtual bool update() { return false; };
 };
 
 #endif /* ABSTRACT_SCROLL_MODEL_H */
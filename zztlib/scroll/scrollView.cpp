@@ -243,8 +243,16 @@ void ScrollView::paint( AbstractPainter *painter )
   }
 }
 
-void ScrollView::update()
+bool ScrollView::update()
 {
+  bool changed = false;
+  if ( d->model && d->model->update() ) {
+    // keep the cursor on a line that's still there
+    d->moveScroll( 1, 0 );
+    if ( d->line < 0 ) d->line = 0;
+    changed = true;
+  }
+
   switch (d->state)
   {
     case ScrollViewPrivate::Opening: {
@@ -265,6 +273,8 @@ void ScrollView::update()
 
     default: break;
   }
+
+  return changed;
 }
 
 void ScrollView::setModel( AbstractScrollModel *model )
@@ -20,7 +20,8 @@ class ScrollView
     virtual ~ScrollView();
 
     void paint( AbstractPainter *painter );
-    void update();
+    /// true when the model's lines changed and need repainting
+    bool update();
 
     void setModel( AbstractScrollModel *model );
     AbstractScrollModel *model() const;
@@ -13,8 +13,10 @@
 
 #include "debug.h"
 #include "zstring.h"
+#include "snapshotStream.h"
 #include "zztEntity.h"
 #include "gameWorld.h"
+#include "randomizer.h"
 #include "gameBoard.h"
 
 #include "zztThing.h"
@@ -35,6 +37,18 @@ void Bear::exec_impl()
   /* */
 }
 
+void Bear::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramSensativity );
+}
+
+void Bear::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramSensativity = in.getInt();
+}
+
 // -------------------------------------
 
 Ruffian::Ruffian()
@@ -49,9 +63,10 @@ Ruffian::Ruffian()
 void Ruffian::exec_impl()
 {
   if ( m_rests == 0 ) {
-    m_moves = rand() % 10;
+    Randomizer &rnd = world()->randomizer();
+    m_moves = rnd.randomRange(10);
     m_rests = m_paramRest;
-    if ( rand() % 9 < m_paramIntel ) {
+    if ( rnd.randomRange(9) < m_paramIntel ) {
       m_direction = seekDir();
     }
     else {
@@ -68,6 +83,26 @@ void Ruffian::exec_impl()
   }
 }
 
+void Ruffian::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramIntel );
+  out.putInt( m_paramRest );
+  out.putInt( m_moves );
+  out.putInt( m_rests );
+  out.putInt( m_direction );
+}
+
+void Ruffian::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramIntel = in.getInt();
+  m_paramRest = in.getInt();
+  m_moves = in.getInt();
+  m_rests = in.getInt();
+  m_direction = in.getInt();
+}
+
 // -------------------------------------
 
 Slime::Slime()
@@ -80,6 +115,18 @@ void Slime::exec_impl()
   /* */
 }
 
+void Slime::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramSpeed );
+}
+
+void Slime::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramSpeed = in.getInt();
+}
+
 // -------------------------------------
 
 Shark::Shark()
@@ -93,6 +140,18 @@ void Shark::exec_impl()
   /* */
 }
 
+void Shark::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramIntel );
+}
+
+void Shark::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramIntel = in.getInt();
+}
+
 // -------------------------------------
 
 Lion::Lion()
@@ -106,6 +165,18 @@ void Lion::exec_impl()
   doMove( randAnyDir() );
 }
 
+void Lion::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramIntel );
+}
+
+void Lion::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramIntel = in.getInt();
+}
+
 // -------------------------------------
 
 Tiger::Tiger()
@@ -119,6 +190,18 @@ void Tiger::exec_impl()
   doMove( randAnyDir() );
 }
 
+void Tiger::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramIntel );
+}
+
+void Tiger::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramIntel = in.getInt();
+}
+
 // -------------------------------------
 
 // reference notes:
@@ -190,7 +273,10 @@ void CentipedeHead::findSegments()
     const int segCount = segs.size();
     if ( segCount == 0 || segCount == 4 ) break;
     if ( segCount > 1 ) {
-      random_shuffle ( segs.begin(), segs.end() );
+      Randomizer &rnd = world()->randomizer();
+      for ( int i = segCount - 1; i > 0; i-- ) {
+        std::swap( segs[i], segs[ rnd.randomRange( i + 1 ) ] );
+      }
     }
 
     addedBody = false;
@@ -270,6 +356,41 @@ void CentipedeHead::handleLosingSegment( CentipedeSegment *segment )
   }
 }
 
+void CentipedeHead::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putInt( m_paramIntel );
+  out.putInt( m_paramDeviance );
+  out.putInt( m_direction );
+  out.putInt( m_settleTime );
+
+  out.putWord( m_body.size() );
+  CentipedeBody::const_iterator iter;
+  for ( iter = m_body.begin(); iter != m_body.end(); iter++ ) {
+    out.putWord( table.thingIndex( *iter ) );
+  }
+}
+
+void CentipedeHead::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_paramIntel = in.getInt();
+  m_paramDeviance = in.getInt();
+  m_direction = in.getInt();
+  m_settleTime = in.getInt();
+
+  m_body.clear();
+  const int segments = in.getWord();
+  for ( int i = 0; i < segments && in.ok(); i++ ) {
+    AbstractThing *thing = table.thing( (signed short) in.getWord() );
+    if ( !thing || thing->entityID() != ZZTEntity::CentipedeSegment ) {
+      in.fail();
+      return;
+    }
+    m_body.push_back( static_cast<CentipedeSegment*>(thing) );
+  }
+}
+
 // -------------------------------------
 
 CentipedeSegment::CentipedeSegment()
@@ -298,6 +419,25 @@ void CentipedeSegment::exec_impl()
   }
 }
 
+void CentipedeSegment::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putWord( table.thingIndex( m_head ) );
+  out.putInt( m_isolated );
+}
+
+void CentipedeSegment::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  AbstractThing *thing = table.thing( (signed short) in.getWord() );
+  if ( thing && thing->entityID() != ZZTEntity::CentipedeHead ) {
+    in.fail();
+    thing = 0;
+  }
+  m_head = static_cast<CentipedeHead*>(thing);
+  m_isolated = in.getInt();
+}
+
 void CentipedeSegment::becomeHead()
 {
   assert( m_head == 0 );
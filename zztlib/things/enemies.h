@@ -27,6 +27,10 @@ class Bear : public AbstractThing
     virtual unsigned char tile() const { return 0x99; };
 
     void setSensativity( int sense ) { m_paramSensativity = sense; };
+    int sensativity() const { return m_paramSensativity; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -45,7 +49,12 @@ class Ruffian : public AbstractThing
     virtual unsigned char tile() const { return 0x05; };
 
     void setIntelligence( int intel ) { m_paramIntel = intel; };
+    int intelligence() const { return m_paramIntel; };
     void setRest( int rest ) { m_paramRest = rest; };
+    int rest() const { return m_paramRest; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -68,6 +77,10 @@ class Slime : public AbstractThing
     virtual unsigned char tile() const { return 0x2A; };
 
     void setSpeed( int speed ) { m_paramSpeed = speed; };
+    int speed() const { return m_paramSpeed; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -86,6 +99,10 @@ class Shark : public AbstractThing
     virtual unsigned char tile() const { return 0x5E; };
 
     void setIntelligence( int intel ) { m_paramIntel = intel; };
+    int intelligence() const { return m_paramIntel; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -104,6 +121,10 @@ class Lion : public AbstractThing
     virtual unsigned char tile() const { return 0xEA; };
 
     void setIntelligence( int intel ) { m_paramIntel = intel; };
+    int intelligence() const { return m_paramIntel; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -122,6 +143,10 @@ class Tiger : public AbstractThing
     virtual unsigned char tile() const { return 0xE3; };
 
     void setIntelligence( int intel ) { m_paramIntel = intel; };
+    int intelligence() const { return m_paramIntel; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
@@ -143,7 +168,12 @@ class CentipedeHead : public AbstractThing
     virtual unsigned char tile() const { return 0xE9; };
 
     void setIntelligence( int intel ) { m_paramIntel = intel; };
+    int intelligence() const { return m_paramIntel; };
     void setDeviance( int deviance ) { m_paramDeviance = deviance; };
+    int deviance() const { return m_paramDeviance; };
+
+    /// segments in order, nearest the head first
+    const CentipedeBody &body() const { return m_body; };
 
     void moveSegments( int oldX, int oldY );
     void findSegments();
@@ -152,6 +182,9 @@ class CentipedeHead : public AbstractThing
     virtual void handleDeleted();
     void handleLosingSegment( CentipedeSegment *segment );
 
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
+
   protected:
     virtual void exec_impl();
 
@@ -178,6 +211,9 @@ class CentipedeSegment : public AbstractThing
     void becomeHead();
     virtual void handleDeleted();
 
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
+
   protected:
     virtual void exec_impl();
 
@@ -7,6 +7,7 @@
 
 #include "debug.h"
 #include "zstring.h"
+#include "snapshotStream.h"
 #include "defines.h"
 #include "zztEntity.h"
 #include "gameWorld.h"
@@ -33,3 +34,31 @@ void Bullet::interact( int old_x, int old_y, int dx, int dy )
   board()->handleBulletCollision( old_x+dx, old_y+dy, dx, dy, mPlayerType );
 }
 
+void Bullet::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putByte( mDirection );
+  out.putBool( mPlayerType );
+}
+
+void Bullet::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  mDirection = in.getByte();
+  mPlayerType = in.getBool();
+}
+
+// -------------------------------------
+
+void Passage::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putByte( m_destination );
+}
+
+void Passage::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_destination = in.getByte();
+}
+
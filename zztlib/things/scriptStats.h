@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __SCRIPT_STATS_H__
+#define __SCRIPT_STATS_H__
+
+/// ZZT-OOP work counters, kept per object and per board
+class ScriptStats
+{
+  public:
+    ScriptStats() { clear(); };
+
+    void clear()
+    {
+      instructions = 0;
+      freebies = 0;
+      labelsSought = 0;
+      messagesSent = 0;
+      micros = 0;
+    };
+
+    void add( const ScriptStats &other )
+    {
+      instructions += other.instructions;
+      freebies += other.freebies;
+      labelsSought += other.labelsSought;
+      messagesSent += other.messagesSent;
+      micros += other.micros;
+    };
+
+  public:
+    /// lines parsed, including the free ones
+    unsigned int instructions;
+    /// lines that didn't use up any of the cycle budget
+    unsigned int freebies;
+    /// times the object was sent to a label
+    unsigned int labelsSought;
+    /// messages the object sent, to itself or others
+    unsigned int messagesSent;
+    /// time spent running the script, zero without a clock
+    unsigned int micros;
+};
+
+#endif // __SCRIPT_STATS_H__
+
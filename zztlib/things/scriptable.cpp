@@ -14,6 +14,9 @@
 
 #include "debug.h"
 #include "zstring.h"
+#include "snapshotStream.h"
+#include "zstringView.h"
+#include "symbolTable.h"
 #include "zztEntity.h"
 #include "gameWorld.h"
 #include "gameBoard.h"
@@ -27,10 +30,14 @@
 
 using namespace ZZTThing;
 
+// boards get decoded on other threads, so names are interned on first use
+static const int UNRESOLVED_SYMBOL = -2;
+
 ScriptableThing::ScriptableThing()
   : m_ip(0),
     m_paused(true),
-    m_locked(false)
+    m_locked(false),
+    m_nameSymbol(UNRESOLVED_SYMBOL)
 {
   /* */
 }
@@ -42,6 +49,30 @@ inline bool verifyTokens( const std::list<ZString> &tokens,
   return ( tokens.size() >= min );
 }
 
+void ScriptableThing::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  AbstractThing::saveState( out, table );
+  out.putWord( m_ip );
+  out.putBool( m_paused );
+  out.putBool( m_locked );
+  out.putString( m_name );
+  out.putWord( table.programIndex( m_interpreter ) );
+}
+
+void ScriptableThing::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  AbstractThing::loadState( in, table );
+  m_ip = in.getWord();
+  m_paused = in.getBool();
+  m_locked = in.getBool();
+  m_name = in.getString();
+  m_nameSymbol = UNRESOLVED_SYMBOL;
+  m_interpreter = table.program( (signed short) in.getWord() );
+  if ( !m_interpreter ) {
+    in.fail();
+  }
+}
+
 void ScriptableThing::setInterpreter( ZZTOOP::Interpreter *interp )
 {
   m_interpreter = interp;
@@ -53,6 +84,16 @@ void ScriptableThing::setObjectName( const ZString &name )
 {
   zinfo() << "Object named:" << name;
   m_name = name;
+  m_nameSymbol = UNRESOLVED_SYMBOL;
+}
+
+int ScriptableThing::nameSymbol()
+{
+  if ( m_nameSymbol == UNRESOLVED_SYMBOL ) {
+    m_nameSymbol = m_name.empty() ? (int) SymbolTable::None
+                                  : world()->symbols().intern( m_name );
+  }
+  return m_nameSymbol;
 }
 
 void ScriptableThing::setInstructionPointer( signed short ip )
@@ -66,17 +107,29 @@ void ScriptableThing::run( int cycles )
   m_interpreter->run( this, cycles );
 }
 
-void ScriptableThing::seekLabel( const ZString &label )
+void ScriptableThing::seekLabel( const ZStringView &label )
 {
   execSend( label );
 }
 
-void ScriptableThing::execSend( const ZString &label )
+void ScriptableThing::addRunStats( const ScriptStats &stats )
 {
+  m_lastRun = stats;
+  m_totalStats.add( stats );
+  board()->addScriptStats( stats );
+}
+
+void ScriptableThing::execSend( const ZStringView &label )
+{
+  ScriptStats seek;
+  seek.labelsSought = 1;
+  m_totalStats.add( seek );
+  board()->addScriptStats( seek );
+
   m_interpreter->seekLabel( this, label );
 }
 
-void ScriptableThing::execSend( const ZString &to, const ZString &label )
+void ScriptableThing::execSend( const ZStringView &to, const ZStringView &label )
 {
   board()->sendLabel( to, label, this );
 }
@@ -109,13 +162,13 @@ void ScriptableThing::execClear( const ZString &flag )
 void ScriptableThing::execZap( const ZString &label )
 {
   // Deliberate bug. Shared Interpreters are affected by Zap
-  m_interpreter->zapLabel( label );
+  m_interpreter->zapLabel( world()->symbols(), label );
 }
 
 void ScriptableThing::execRestore( const ZString &label )
 {
   // Deliberate bug. Shared Interpreters are affected by Restore
-  m_interpreter->restoreLabel( label );
+  m_interpreter->restoreLabel( world()->symbols(), label );
 }
 
 void ScriptableThing::execBecome( unsigned char id, unsigned char color )
@@ -218,6 +271,18 @@ void Object::exec_impl()
   ScriptableThing::run(33);
 }
 
+void Object::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  ScriptableThing::saveState( out, table );
+  out.putByte( m_char );
+}
+
+void Object::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  ScriptableThing::loadState( in, table );
+  m_char = in.getByte();
+}
+
 void Object::handleTouched()
 {
   zdebug() << "Object::handleTouched";
@@ -11,6 +11,7 @@
 #include "zstring.h"
 #include "zztThing.h"
 #include "zztoopInterp.h"
+#include "scriptStats.h"
 
 class TextScrollModel;
 
@@ -39,8 +40,20 @@ class ScriptableThing : public AbstractThing
 
     void setObjectName( const ZString &name );
     const ZString &objectName() const { return m_name; };
+    /// the name as one of the world's symbols, None if it has no name
+    int nameSymbol();
 
-    void seekLabel( const ZString &label );
+    void seekLabel( const ZStringView &label );
+
+    /// counters from the latest run of the script
+    const ScriptStats &lastRunStats() const { return m_lastRun; };
+    /// counters since the object was loaded
+    const ScriptStats &totalStats() const { return m_totalStats; };
+    /// records one run of the script, also adds it to the board's totals
+    void addRunStats( const ScriptStats &stats );
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
     void showMessage( const ZString &mesg );
     virtual void showScroll( TextScrollModel *model );
@@ -64,8 +77,8 @@ class ScriptableThing : public AbstractThing
     virtual void execPut( int dir, unsigned char id, unsigned char color );
     virtual void execRestart();
     virtual void execRestore( const ZString &label );
-    virtual void execSend( const ZString &message );
-    virtual void execSend( const ZString &to, const ZString &message );
+    virtual void execSend( const ZStringView &message );
+    virtual void execSend( const ZStringView &to, const ZStringView &message );
     virtual void execSet( const ZString &flag );
     virtual void execShoot( int dir );
     virtual void execTake( int item, int amount, const ZString &message );
@@ -83,7 +96,10 @@ class ScriptableThing : public AbstractThing
     bool m_paused;
     bool m_locked;
     ZString m_name;
+    int m_nameSymbol;
     ZZTOOP::Interpreter *m_interpreter;
+    ScriptStats m_lastRun;
+    ScriptStats m_totalStats;
 };
 
 // -------------------------------------
@@ -114,6 +130,9 @@ class Object : public ScriptableThing
 
     virtual void handleTouched();
 
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
+
   protected:
     virtual void exec_impl();
 
@@ -6,11 +6,15 @@
  */
 
 #include <cstdlib>
+#include <vector>
+#include <algorithm>
 
 #include "debug.h"
 #include "zstring.h"
+#include "snapshotStream.h"
 #include "zztEntity.h"
 #include "gameWorld.h"
+#include "randomizer.h"
 #include "gameBoard.h"
 
 #include "zztThing.h"
@@ -86,7 +90,8 @@ int AbstractThing::cycle() const
 
 void AbstractThing::updateEntity()
 {
-  // Bad place for this? consider moving it
+  // the board calls this at the top of each cycle, and exec clears it,
+  // so nothing runs twice after moving further along the field.
   m_canExec = true;
 
   ZZTEntity ent = board()->entity( xPos(), yPos() );
@@ -272,7 +277,7 @@ int AbstractThing::seekDir() const
   if ( diry == Idle ) return dirx;
 
   // pick a random of the two possible directions
-  if ( rand() % 2 == 0 ) return dirx;
+  if ( world()->randomizer().randomRange(2) == 0 ) return dirx;
   return diry;
 }
 
@@ -316,7 +321,7 @@ bool AbstractThing::alignedPlayer() const
 
 int AbstractThing::randAnyDir()
 {
-  return (rand() % 4) + 1;
+  return world()->randomizer().randomRange(4) + 1;
 }
 
 int AbstractThing::randNotBlockedDir()
@@ -328,8 +333,9 @@ int AbstractThing::randNotBlockedDir()
   dirs[3] = East;
 
   // shuffle
+  Randomizer &rnd = world()->randomizer();
   for ( int i = 0; i < 4; i++ ) {
-    const int r = rand() % ( 4 - i );
+    const int r = i + rnd.randomRange( 4 - i );
     const int t = dirs[i];
     dirs[i] = dirs[r];
     dirs[r] = t;
@@ -418,3 +424,83 @@ void AbstractThing::exec()
   m_canExec = false;
 }
 
+void AbstractThing::saveState( SnapshotWriter &out, const SnapshotTable &table ) const
+{
+  out.putByte( position_x );
+  out.putByte( position_y );
+  out.putInt( m_cycle );
+  out.putBool( m_canExec );
+  table.writeEntity( out, under_entity );
+  out.putByte( m_fileHeader.size() );
+  if ( !m_fileHeader.empty() ) {
+    out.putBytes( &m_fileHeader[0], m_fileHeader.size() );
+  }
+}
+
+void AbstractThing::loadState( SnapshotReader &in, const SnapshotTable &table )
+{
+  position_x = in.getByte();
+  position_y = in.getByte();
+  m_cycle = in.getInt();
+  m_canExec = in.getBool();
+  under_entity = table.readEntity( in );
+  const int headerLength = in.getByte();
+  const unsigned char *header = in.getBytes( headerLength );
+  if ( header ) {
+    m_fileHeader.assign( header, header + headerLength );
+  }
+}
+
+void AbstractThing::setFileHeader( const unsigned char *data, int length )
+{
+  m_fileHeader.assign( data, data + length );
+}
+
+// -------------------------------------
+
+int SnapshotTable::thingIndex( const AbstractThing *thing ) const
+{
+  if (!thing) return -1;
+  std::vector<AbstractThing*>::const_iterator iter =
+    std::find( things.begin(), things.end(), thing );
+  return ( iter == things.end() ) ? -1 : ( iter - things.begin() );
+}
+
+AbstractThing *SnapshotTable::thing( int index ) const
+{
+  if ( index < 0 || index >= (int) things.size() ) return 0;
+  return things[index];
+}
+
+int SnapshotTable::programIndex( const ZZTOOP::Interpreter *program ) const
+{
+  if (!program) return -1;
+  std::vector<ZZTOOP::Interpreter*>::const_iterator iter =
+    std::find( programs.begin(), programs.end(), program );
+  return ( iter == programs.end() ) ? -1 : ( iter - programs.begin() );
+}
+
+ZZTOOP::Interpreter *SnapshotTable::program( int index ) const
+{
+  if ( index < 0 || index >= (int) programs.size() ) return 0;
+  return programs[index];
+}
+
+void SnapshotTable::writeEntity( SnapshotWriter &out, const ZZTEntity &entity ) const
+{
+  out.putByte( entity.id() );
+  out.putByte( entity.color() );
+  out.putByte( entity.tile() );
+  out.putWord( thingIndex( entity.thing() ) );
+}
+
+ZZTEntity SnapshotTable::readEntity( SnapshotReader &in ) const
+{
+  const unsigned char id = in.getByte();
+  const unsigned char color = in.getByte();
+  const unsigned char tile = in.getByte();
+  ZZTEntity entity( id, color, tile );
+  entity.setThing( thing( (signed short) in.getWord() ) );
+  return entity;
+}
+
@@ -8,11 +8,18 @@
 #ifndef ZZT_THING_H
 #define ZZT_THING_H
 
+#include <vector>
 #include "zztEntity.h"
 
 class GameWorld;
 class GameBoard;
 class AbstractMusicStream;
+class SnapshotWriter;
+class SnapshotReader;
+
+namespace ZZTOOP {
+  class Interpreter;
+}
 
 // =================
 
@@ -33,6 +40,34 @@ enum Direction {
 
 // -------------------------------------
 
+class AbstractThing;
+
+/// Maps things and programs to indices and back while a board
+/// is being saved or loaded, since pointers don't survive a snapshot.
+class SnapshotTable
+{
+  public:
+    std::vector<AbstractThing*> things;
+    std::vector<ZZTOOP::Interpreter*> programs;
+
+    /// -1 for none
+    int thingIndex( const AbstractThing *thing ) const;
+    /// 0 for anything out of range
+    AbstractThing *thing( int index ) const;
+
+    /// -1 for none
+    int programIndex( const ZZTOOP::Interpreter *program ) const;
+    /// 0 for anything out of range
+    ZZTOOP::Interpreter *program( int index ) const;
+
+    /// writes an entity, with its thing as an index
+    void writeEntity( SnapshotWriter &out, const ZZTEntity &entity ) const;
+    /// reads an entity written by writeEntity
+    ZZTEntity readEntity( SnapshotReader &in ) const;
+};
+
+// -------------------------------------
+
 /// The interactive object superclass
 class AbstractThing
 {
@@ -96,6 +131,18 @@ class AbstractThing
     /// aligned with the player
     bool alignedPlayer() const;
 
+    /// writes the thing's state for a board snapshot
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+
+    /// reads back what saveState wrote
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
+
+    /// keeps the thing's header from the world file, so the parts the
+    /// engine doesn't use can be written back out
+    void setFileHeader( const unsigned char *data, int length );
+    /// empty for things that didn't come from a world file
+    const std::vector<unsigned char> &fileHeader() const { return m_fileHeader; };
+
   protected:
     /// test if movement to a particular space is possible
     bool blocked( int old_x, int old_y, int x_step, int y_step ) const;
@@ -196,6 +243,7 @@ class AbstractThing
     bool m_canExec;
 
     ZZTEntity under_entity;
+    std::vector<unsigned char> m_fileHeader;
 };
 
 // -------------------------------------
@@ -210,6 +258,9 @@ class Passage : public AbstractThing
     void setDestination( unsigned char dest ) { m_destination = dest; };
     unsigned char destination() const { return m_destination; };
 
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
+
   protected:
     virtual void exec_impl() { /* */ };
 
@@ -291,7 +342,13 @@ class Bullet : public AbstractThing
       mDirection = translateStep( x, y );
     };
 
+    int direction() const { return mDirection; };
+
     void setType( bool playerType ) { mPlayerType = playerType; };
+    bool playerType() const { return mPlayerType; };
+
+    virtual void saveState( SnapshotWriter &out, const SnapshotTable &table ) const;
+    virtual void loadState( SnapshotReader &in, const SnapshotTable &table );
 
   protected:
     virtual void exec_impl();
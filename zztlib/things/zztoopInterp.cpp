@@ -6,14 +6,16 @@
 #include <cstdlib>
 #include <memory>
 #include <vector>
-#include <map>
 
 #include "debug.h"
 #include "defines.h"
+#include "abstractClock.h"
 #include "zstring.h"
+#include "zstringView.h"
 #include "gameBoard.h"
 #include "gameWorld.h"
 #include "randomizer.h"
+#include "symbolTable.h"
 #include "scriptable.h"
 #include "textScrollModel.h"
 #include "zztoopInterp.h"
@@ -73,41 +75,6 @@ signed short seekForward( const ProgramBank &program, signed short ip, const ZSt
   return ip;
 }
 
-bool seekToken( const ProgramBank &program, const ZString &delimiter,
-                const ZString &label, signed short &targetIP, bool impliedLabels )
-{
-  // I wonder how slow this approach is.
-  ZString capSeek = label.upper();
-
-  // restart is an implied lable.
-  if ( impliedLabels &&
-       ( 0 == capSeek.compare("RESTART") ) )
-  {
-    targetIP = 0;
-    return true;
-  }
-
-  const int size = length(program);
-  signed short ip = 0;
-  while ( ip < size )
-  {
-    const unsigned char symbol = program.at( ip );
-
-    if ( delimiter.find(symbol) != ZString::npos ) {
-      signed short delimiterIP = ip;
-      ip++;
-      if ( ip >= size ) break;
-      ZString token = getOneToken( program, ip, tokenDelimiters );
-      if ( 0 == token.upper().compare( capSeek ) ) {
-        targetIP = delimiterIP;
-        return true;
-      }
-    }
-    ip = seekForward( program, ip, wholeLineDelimiter );
-    if ( ip < size ) ip++;
-  }
-  return false;
-}
 
 // ---------------------------------------------------------------------------
 
@@ -236,14 +203,222 @@ namespace Token
 
 // ---------------------------------------------------------------------------
 
+// Keyword lookup is a perfect hash: an FNV-1a of the upper-cased word
+// picks a bucket, and the bucket's displacement mixes the same hash into
+// a slot that holds at most one keyword. Nothing is built at runtime, so
+// it's safe from any thread, and a lookup is one pass over the word plus
+// one compare. The table was laid out offline, adding a keyword means
+// finding new displacements for it. The layout is checked on the first
+// lookup in every build, see lookupKeyword.
+
+static const int keywordBuckets = 32;
+static const int keywordSlots = 128;
+
+static const unsigned char keywordDisplacement[ keywordBuckets ] = {
+    2,  10,   2,   1,   0,   6,   3,   1,
+    3,   1,  12,  11,   0,  16,   0,   8,
+    0,   0,   1,   1,   1,   0,   0,  15,
+   29,   2,  11,   2,   0,   1,   3,   6
+};
+
+struct Keyword
+{
+  const char *word;
+  Token::Code code;
+};
+
+static const Keyword keywordTable[ keywordSlots ] = {
+  { "NORTH", Token::NORTH },
+  { 0, Token::UNKNOWN },
+  { "CYAN", Token::CYAN },
+  { 0, Token::UNKNOWN },
+  { "FLOW", Token::FLOW },
+  { "PASSAGE", Token::PASSAGE },
+  { "SHARK", Token::SHARK },
+  { "HEALTH", Token::HEALTH },
+  { "WHITE", Token::WHITE },
+  { 0, Token::UNKNOWN },
+  { "W", Token::WEST },
+  { 0, Token::UNKNOWN },
+  { "ALLIGNED", Token::ALIGNED }, // aligned is mispelt in ZZT.exe
+  { "WATER", Token::WATER },
+  { 0, Token::UNKNOWN },
+  { "RICOCHET", Token::RICOCHET },
+  { "OBJECT", Token::OBJECT },
+  { "BOMB", Token::BOMB },
+  { "SEGMENT", Token::SEGMENT },
+  { "GEM", Token::GEM },
+  { 0, Token::UNKNOWN },
+  { "YELLOW", Token::YELLOW },
+  { 0, Token::UNKNOWN },
+  { "PLAYER", Token::PLAYER },
+  { "CHANGE", Token::CHANGE },
+  { 0, Token::UNKNOWN },
+  { 0, Token::UNKNOWN },
+  { "EMPTY", Token::EMPTY },
+  { 0, Token::UNKNOWN },
+  { "LOCK", Token::LOCK },
+  { "DUPLICATOR", Token::DUPLICATOR },
+  { "SET", Token::SET },
+  { "TRANSPORTER", Token::TRANSPORTER },
+  { "RANDNS", Token::RANDNS },
+  { "BECOME", Token::BECOME },
+  { "GIVE", Token::GIVE },
+  { 0, Token::UNKNOWN },
+  { "TIGER", Token::TIGER },
+  { 0, Token::UNKNOWN },
+  { "LINE", Token::LINE },
+  { "RESTORE", Token::RESTORE },
+  { "KEY", Token::KEY },
+  { "EAST", Token::EAST },
+  { "ENERGIZED", Token::ENERGIZED },
+  { 0, Token::UNKNOWN },
+  { "CLEAR", Token::CLEAR },
+  { "CLOCKWISE", Token::CLOCKWISE },
+  { "CONTACT", Token::CONTACT },
+  { "PUSHER", Token::PUSHER },
+  { "TAKE", Token::TAKE },
+  { "ZAP", Token::ZAP },
+  { "N", Token::NORTH },
+  { "AMMO", Token::AMMO },
+  { "ENERGIZER", Token::ENERGIZER },
+  { "INVISIBLE", Token::INVISIBLE },
+  { "SEND", Token::SEND },
+  { "BLACK", Token::BLACK },
+  { "NORMAL", Token::NORMAL },
+  { "MONITOR", Token::MONITOR },
+  { "SCORE", Token::SCORE },
+  { "WEST", Token::WEST },
+  { "GEMS", Token::GEMS },
+  { 0, Token::UNKNOWN },
+  { "RUFFIAN", Token::RUFFIAN },
+  { "SLIDEREW", Token::SLIDEREW },
+  { 0, Token::UNKNOWN },
+  { "IDLE", Token::IDLE },
+  { "GO", Token::GO },
+  { 0, Token::UNKNOWN },
+  { "TIME", Token::TIME },
+  { 0, Token::UNKNOWN },
+  { 0, Token::UNKNOWN },
+  { "WALK", Token::WALK },
+  { "SOLID", Token::SOLID },
+  { "FOREST", Token::FOREST },
+  { "RANDP", Token::RANDP },
+  { "RED", Token::RED },
+  { "TORCH", Token::TORCH },
+  { "ANY", Token::ANY },
+  { "RANDNE", Token::RANDNE },
+  { 0, Token::UNKNOWN },
+  { 0, Token::UNKNOWN },
+  { "BLOCKED", Token::BLOCKED },
+  { "SPINNINGGUN", Token::SPINNINGGUN },
+  { "UNLOCK", Token::UNLOCK },
+  { "BEAR", Token::BEAR },
+  { "IF", Token::IF },
+  { 0, Token::UNKNOWN },
+  { "TRY", Token::TRY },
+  { "BLUE", Token::BLUE },
+  { "LION", Token::LION },
+  { "FAKE", Token::FAKE },
+  { "BIND", Token::BIND },
+  { "COUNTER", Token::COUNTER },
+  { "DIE", Token::DIE },
+  { "ENDGAME", Token::ENDGAME },
+  { "S", Token::SOUTH },
+  { "PURPLE", Token::PURPLE },
+  { 0, Token::UNKNOWN },
+  { "END", Token::END },
+  { "SLIDERNS", Token::SLIDERNS },
+  { "BREAKABLE", Token::BREAKABLE },
+  { "SEEK", Token::SEEK },
+  { "THROWSTAR", Token::THROWSTAR },
+  { "BULLET", Token::BULLET },
+  { "NOT", Token::NOT },
+  { 0, Token::UNKNOWN },
+  { "HEAD", Token::HEAD },
+  { "E", Token::EAST },
+  { 0, Token::UNKNOWN },
+  { "SLIME", Token::SLIME },
+  { "BLINKWALL", Token::BLINKWALL },
+  { "STAR", Token::STAR },
+  { "BOULDER", Token::BOULDER },
+  { 0, Token::UNKNOWN },
+  { "RESTART", Token::RESTART },
+  { "CHAR", Token::CHAR },
+  { "CYCLE", Token::CYCLE },
+  { "SCROLL", Token::SCROLL },
+  { 0, Token::UNKNOWN },
+  { "DOOR", Token::DOOR },
+  { "GREEN", Token::GREEN },
+  { "PLAY", Token::PLAY },
+  { "SHOOT", Token::SHOOT },
+  { "SOUTH", Token::SOUTH },
+  { 0, Token::UNKNOWN },
+  { "PUT", Token::PUT },
+  { "OPPOSITE", Token::OPPOSITE }
+};
+
+static int keywordSlot( const ZStringView &word )
+{
+  const unsigned int hash = word.hashNoCase();
+  unsigned int x = hash ^ ( keywordDisplacement[ hash % keywordBuckets ] * 2654435761u );
+  x ^= x >> 15;
+  x *= 2246822507u;
+  x ^= x >> 13;
+  return x % keywordSlots;
+}
+
+/// true if every keyword sits in the slot its hash picks
+static bool checkKeywordTable()
+{
+  bool good = true;
+  for ( int i = 0; i < keywordSlots; i++ ) {
+    if ( !keywordTable[i].word ) continue;
+    if ( keywordSlot( keywordTable[i].word ) != i ) {
+      zerror() << "ZZTOOP: keyword table misplaces" << keywordTable[i].word;
+      good = false;
+    }
+  }
+  return good;
+}
+
+static Token::Code lookupKeyword( const ZStringView &word )
+{
+  // checked once, on the first lookup, in every build. a bad layout
+  // falls back to searching the whole table instead of misreading code.
+  static const bool tableGood = checkKeywordTable();
+
+  if ( !tableGood ) {
+    for ( int i = 0; i < keywordSlots; i++ ) {
+      const Keyword &keyword = keywordTable[i];
+      if ( keyword.word && word.equalsNoCase( keyword.word ) ) {
+        return keyword.code;
+      }
+    }
+    return Token::UNKNOWN;
+  }
+
+  const Keyword &keyword = keywordTable[ keywordSlot( word ) ];
+  if ( !keyword.word || !word.equalsNoCase( keyword.word ) ) {
+    return Token::UNKNOWN;
+  }
+  return keyword.code;
+}
+
+// ---------------------------------------------------------------------------
+
+/// Walks the words of one line. The line is a view into the program
+/// bytes and every word is a view into the line, so nothing is copied
+/// until someone asks for string().
 class Tokenizer
 {
   public:
-    Tokenizer( const ZString &str = "" );
+    Tokenizer( const ZStringView &str = ZStringView() );
 
     void next();
     Token::Code token() const { return current; };
-    ZString string() const { return word; };
+    ZString string() const { return word.str(); };
+    ZStringView view() const { return word; };
     int number() const { return word.sint(); };
     bool done() const { return current == Token::ENDOFLINE; };
 
@@ -251,173 +426,58 @@ class Tokenizer
     Token::Code identifySymbol( const char c ) const;
 
   private:
-    ZString line;
-    ZString word;
+    ZStringView line;
+    ZStringView word;
     Token::Code current;
     size_t left;
     size_t right;
-
-    typedef map<ZString, Token::Code> TokenMapper;
-    static TokenMapper mapper;
 };
 
-Tokenizer::TokenMapper Tokenizer::mapper;
-
-Tokenizer::Tokenizer( const ZString &str )
+Tokenizer::Tokenizer( const ZStringView &str )
   : line( str ),
     current( Token::UNKNOWN ),
     left(0),
     right(0)
 {
-  if ( mapper.empty() ) 
-  {
-    mapper["ANY"] = Token::ANY;
-    mapper["ALLIGNED"] = Token::ALIGNED; // aligned is mispelt in ZZT.exe
-    mapper["CONTACT"] = Token::CONTACT;
-    mapper["ENERGIZED"] = Token::ENERGIZED;
-    mapper["BLOCKED"] = Token::BLOCKED;
-    mapper["NOT"] = Token::NOT;
-
-    mapper["AMMO"] = Token::AMMO;
-    mapper["TORCH"] = Token::TORCH;
-    mapper["GEMS"] = Token::GEMS;
-    mapper["HEALTH"] = Token::HEALTH;
-    mapper["TIME"] = Token::TIME;
-    mapper["SCORE"] = Token::SCORE;
-
-    mapper["BLACK"] = Token::BLACK;
-    mapper["BLUE"] = Token::BLUE;
-    mapper["CYAN"] = Token::CYAN;
-    mapper["GREEN"] = Token::GREEN;
-    mapper["PURPLE"] = Token::PURPLE;
-    mapper["RED"] = Token::RED;
-    mapper["WHITE"] = Token::WHITE;
-    mapper["YELLOW"] = Token::YELLOW;
-
-    mapper["BECOME"] = Token::BECOME;
-    mapper["BIND"] = Token::BIND;
-    mapper["CHANGE"] = Token::CHANGE;
-    mapper["CHAR"] = Token::CHAR;
-    mapper["CLEAR"] = Token::CLEAR;
-    mapper["CYCLE"] = Token::CYCLE;
-    mapper["DIE"] = Token::DIE;
-    mapper["END"] = Token::END;
-    mapper["ENDGAME"] = Token::ENDGAME;
-    mapper["GIVE"] = Token::GIVE;
-    mapper["GO"] = Token::GO;
-    mapper["IDLE"] = Token::IDLE;
-    mapper["IF"] = Token::IF;
-    mapper["LOCK"] = Token::LOCK;
-    mapper["PLAY"] = Token::PLAY;
-    mapper["PUT"] = Token::PUT;
-    mapper["RESTART"] = Token::RESTART;
-    mapper["RESTORE"] = Token::RESTORE;
-    mapper["SEND"] = Token::SEND;
-    mapper["SET"] = Token::SET;
-    mapper["SHOOT"] = Token::SHOOT;
-    mapper["TAKE"] = Token::TAKE;
-    mapper["THROWSTAR"] = Token::THROWSTAR;
-    mapper["TRY"] = Token::TRY;
-    mapper["UNLOCK"] = Token::UNLOCK;
-    mapper["WALK"] = Token::WALK;
-    mapper["ZAP"] = Token::ZAP;
-
-    mapper["N"] = Token::NORTH;
-    mapper["NORTH"] = Token::NORTH;
-    mapper["S"] = Token::SOUTH;
-    mapper["SOUTH"] = Token::SOUTH;
-    mapper["W"] = Token::WEST;
-    mapper["WEST"] = Token::WEST;
-    mapper["E"] = Token::EAST;
-    mapper["EAST"] = Token::EAST;
-    mapper["CLOCKWISE"] = Token::CLOCKWISE;
-    mapper["COUNTER"] = Token::COUNTER;
-    mapper["SEEK"] = Token::SEEK;
-    mapper["FLOW"] = Token::FLOW;
-    mapper["OPPOSITE"] = Token::OPPOSITE;
-    mapper["RANDNS"] = Token::RANDNS;
-    mapper["RANDNE"] = Token::RANDNE;
-    mapper["RANDP"] = Token::RANDP;
-
-    mapper["BEAR"] == Token::BEAR;
-    mapper["BLINKWALL"] == Token::BLINKWALL;
-    mapper["BOMB"] == Token::BOMB;
-    mapper["BOULDER"] == Token::BOULDER;
-    mapper["BULLET"] == Token::BULLET;
-    mapper["BREAKABLE"] == Token::BREAKABLE;
-    mapper["DOOR"] == Token::DOOR;
-    mapper["DUPLICATOR"] == Token::DUPLICATOR;
-    mapper["EMPTY"] == Token::EMPTY;
-    mapper["ENERGIZER"] == Token::ENERGIZER;
-    mapper["FAKE"] == Token::FAKE;
-    mapper["FOREST"] == Token::FOREST;
-    mapper["GEM"] == Token::GEM;
-    mapper["HEAD"] == Token::HEAD;
-    mapper["INVISIBLE"] == Token::INVISIBLE;
-    mapper["KEY"] == Token::KEY;
-    mapper["LINE"] == Token::LINE;
-    mapper["LION"] == Token::LION;
-    mapper["MONITOR"] == Token::MONITOR;
-    mapper["NORMAL"] == Token::NORMAL;
-    mapper["OBJECT"] == Token::OBJECT;
-    mapper["PASSAGE"] == Token::PASSAGE;
-    mapper["PLAYER"] == Token::PLAYER;
-    mapper["PUSHER"] == Token::PUSHER;
-    mapper["RICOCHET"] == Token::RICOCHET;
-    mapper["RUFFIAN"] == Token::RUFFIAN;
-    mapper["SCROLL"] == Token::SCROLL;
-    mapper["SEGMENT"] == Token::SEGMENT;
-    mapper["SHARK"] == Token::SHARK;
-    mapper["SLIDEREW"] == Token::SLIDEREW;
-    mapper["SLIDERNS"] == Token::SLIDERNS;
-    mapper["SLIME"] == Token::SLIME;
-    mapper["SOLID"] == Token::SOLID;
-    mapper["SPINNINGGUN"] == Token::SPINNINGGUN;
-    mapper["STAR"] == Token::STAR;
-    mapper["TIGER"] == Token::TIGER;
-    mapper["TRANSPORTER"] == Token::TRANSPORTER;
-    mapper["WATER"] == Token::WATER;
-  }
-
   next();
 }
 
 void Tokenizer::next()
 {
   // check end of line
-  if ( left >= line.length() ) {
+  if ( left >= line.size() ) {
     current = Token::ENDOFLINE;
-    word.clear();
+    word = ZStringView();
     return;
   }
 
   // Only scan forward when not at start of line
   if ( left != 0 ) {
-    left = line.find_first_not_of( tokenDelimiters, right );
-    if ( left == string::npos ) {
-      left = line.length();
+    left = line.findFirstNotOf( tokenDelimiters, right );
+    if ( left == ZStringView::npos ) {
+      left = line.size();
       right = left;
       current = Token::ENDOFLINE;
-      word.clear();
+      word = ZStringView();
       return;
     }
   }
 
   // check for line starting symbols
-  current = identifySymbol( line.at( left ) );
+  current = identifySymbol( line[ left ] );
   if ( current != Token::UNKNOWN ) {
-    word = ZString(1, line.at( left ));
+    word = line.sub( left, 1 );
     left += 1;
     right = left;
     return;
   }
 
   // multi-symbol token, so get the whole thing.
-  right = line.find_first_of( tokenDelimiters, left );
-  if ( right == string::npos ) {
-    right = line.length();
+  right = line.findFirstOf( tokenDelimiters, left );
+  if ( right == ZStringView::npos ) {
+    right = line.size();
   }
-  word = line.substr( left, right-left );
+  word = line.sub( left, right-left );
 
   // check if it's a number
   if ( word.isNumber() ) {
@@ -425,16 +485,8 @@ void Tokenizer::next()
     return;
   }
 
-  // identify a word
-  TokenMapper::iterator iter = mapper.find(word.upper());
-
-  if ( iter != mapper.end() ) {
-    current = iter->second;
-    return;
-  }
-
-  // couldn't identify it.
-  current = Token::UNKNOWN;
+  // identify a word, UNKNOWN if it isn't one.
+  current = lookupKeyword( word );
 }
 
 Token::Code Tokenizer::identifySymbol( const char c ) const
@@ -494,9 +546,9 @@ int cardinal_opposite( int dir )
   return DIRECTION_ERROR;
 }
 
-int cardinal_randp( int dir )
+int cardinal_randp( Randomizer &rnd, int dir )
 {
-  int r = Randomizer::randomRange(2);
+  int r = rnd.randomRange(2);
   switch ( dir ) {
     case ZZTThing::North:
     case ZZTThing::South: return r ? ZZTThing::West : ZZTThing::East; break;
@@ -507,15 +559,15 @@ int cardinal_randp( int dir )
   return DIRECTION_ERROR;
 }
 
-int cardinal_randns()
+int cardinal_randns( Randomizer &rnd )
 {
-  int r = Randomizer::randomRange(2);
+  int r = rnd.randomRange(2);
   return r ? ZZTThing::North : ZZTThing::South;
 }
 
-int cardinal_randne()
+int cardinal_randne( Randomizer &rnd )
 {
-  int r = Randomizer::randomRange(2);
+  int r = rnd.randomRange(2);
   return r ? ZZTThing::North : ZZTThing::East;
 }
 
@@ -604,9 +656,10 @@ class Runtime
     void seekNextLine();
     void seekNextToken();
 
-    void sendMessage( const ZString &mesg );
+    void sendMessage( const ZStringView &mesg );
 
     ZString readLine();
+    ZStringView lineView() const;
     ZString getToken();
 
     KILLENUM execBecome();
@@ -655,6 +708,7 @@ class Runtime
     int size;
     vector<ZString> displayLines;
     bool advanceIP;
+    ScriptStats stats;
 
     Tokenizer tokenizer;
 };
@@ -679,6 +733,9 @@ Runtime::~Runtime()
 
 void Runtime::run( int cycles )
 {
+  AbstractClock *clock = world->scriptClock();
+  const unsigned int startTime = clock ? clock->currentMicros() : 0;
+
   while ( cycles > 0 )
   {
     if ( thing->paused() ) break;
@@ -686,10 +743,17 @@ void Runtime::run( int cycles )
     if ( ip >= length(program) ) break;
 
     KILLENUM kill = parseNext();
+    stats.instructions += 1;
 
     if ( kill == PROCEED ) cycles --;
-    else if ( kill != FREEBIE ) break;
+    else if ( kill == FREEBIE ) stats.freebies += 1;
+    else break;
+  }
+
+  if ( clock ) {
+    stats.micros = clock->currentMicros() - startTime;
   }
+  thing->addRunStats( stats );
 }
 
 void Runtime::accept( Token::Code token )
@@ -740,6 +804,17 @@ ZString Runtime::readLine()
   return line;
 }
 
+ZStringView Runtime::lineView() const
+{
+  // the program never changes while a line runs, so point right into it
+  const char *start = reinterpret_cast<const char*>( &program[0] ) + ip;
+  signed short end = ip;
+  while ( end < size && program[end] != zztNewLine ) {
+    end++;
+  }
+  return ZStringView( start, end - ip );
+}
+
 ZString Runtime::getToken()
 {
   return ZString();
@@ -751,7 +826,7 @@ KILLENUM Runtime::parseNext()
   startLineIP = ip;
   advanceIP = true;
 
-  ZString line = readLine();
+  const ZStringView line = lineView();
   tokenizer = Tokenizer(line);
 
   KILLENUM ret = FREEBIE;
@@ -783,7 +858,7 @@ KILLENUM Runtime::parseNext()
     default:
     {
       zdebug() << __FILE__ << ":" << __LINE__ << " strings";
-      addString( line );
+      addString( line.str() );
       break;
     }
   }
@@ -876,7 +951,7 @@ KILLENUM Runtime::executeCrunch()
   accept( Token::CRUNCH );
   Token::Code code = tokenizer.token();
 
-  zdebug() << __FILE__ << ":" << __LINE__ << code << tokenizer.string();
+  zdebug() << __FILE__ << ":" << __LINE__ << code << tokenizer.view();
 
   KILLENUM ret = PROCEED;
   switch ( code ) {
@@ -909,7 +984,7 @@ KILLENUM Runtime::executeCrunch()
     case Token::ZAP: ret = execZap(); break;
     case Token::ENDOFLINE: ret = throwError("COMMAND ERROR");
     default: {
-      sendMessage( tokenizer.string() );
+      sendMessage( tokenizer.view() );
       break;
     }
   }
@@ -951,7 +1026,7 @@ KILLENUM Runtime::execChar()
 KILLENUM Runtime::execClear()
 {
   accept( Token::CLEAR );
-  world->removeGameFlag( tokenizer.string() );
+  world->removeGameFlag( tokenizer.view() );
   accept();
   return PROCEED;
 }
@@ -1064,12 +1139,17 @@ bool Runtime::parseConditional( KILLENUM &kill )
       accept( Token::NOT );
       return !parseConditional(kill);
 
+    case Token::ENDOFLINE:
+      return false;
+
     default:
-      // check flag
       break;
   }
 
-  return false;
+  // anything else is a flag
+  const bool isSet = world->hasGameFlag( tokenizer.view() );
+  accept();
+  return isSet;
 }
 
 bool Runtime::parseConditionalAny( KILLENUM &kill )
@@ -1158,7 +1238,7 @@ KILLENUM Runtime::execRestore()
 KILLENUM Runtime::execSend()
 {
   accept( Token::SEND );
-  sendMessage( tokenizer.string() );
+  sendMessage( tokenizer.view() );
   accept();
   return PROCEED;
 }
@@ -1166,7 +1246,7 @@ KILLENUM Runtime::execSend()
 KILLENUM Runtime::execSet()
 {
   accept( Token::SET );
-  world->addGameFlag( tokenizer.string() );
+  world->addGameFlag( tokenizer.view() );
   accept();
   return PROCEED;
 }
@@ -1213,7 +1293,7 @@ KILLENUM Runtime::execTry()
 
   const bool didMove = thing->execTry( dir );
   if ( !didMove ) {
-    sendMessage( tokenizer.string() );
+    sendMessage( tokenizer.view() );
     return ENDCYCLE;
   }
   return PROCEED;
@@ -1238,16 +1318,19 @@ KILLENUM Runtime::execZap()
   return PROCEED;
 }
 
-void Runtime::sendMessage( const ZString &mesg )
+void Runtime::sendMessage( const ZStringView &mesg )
 {
-  size_t delim = mesg.find_first_of(':');
+  stats.messagesSent += 1;
+
+  // both halves stay views into the program, sends don't allocate
+  size_t delim = mesg.findFirstOf(":");
 
-  if ( delim == string::npos ) {
+  if ( delim == ZStringView::npos ) {
     thing->seekLabel( mesg );
   }
   else {
-    ZString to = mesg.substr( 0, delim-1 );
-    ZString label = mesg.substr( delim+1 );
+    const ZStringView to = mesg.sub( 0, delim );
+    const ZStringView label = mesg.sub( delim+1, mesg.size() );
     board->sendLabel( to, label, thing );
   }
 }
@@ -1302,15 +1385,15 @@ int Runtime::parseDirection( const int stackLimit )
 
     case Token::RANDNS:
       accept( Token::RANDNS );
-      return cardinal_randns();
+      return cardinal_randns( world->randomizer() );
 
     case Token::RANDNE:
       accept( Token::RANDNE );
-      return cardinal_randne();
+      return cardinal_randne( world->randomizer() );
 
     case Token::RANDP:
       accept( Token::RANDP );
-      return cardinal_randp( parseDirection( stackLimit - 1 ) );
+      return cardinal_randp( world->randomizer(), parseDirection( stackLimit - 1 ) );
 
     default:
       return DIRECTION_ERROR;
@@ -1324,6 +1407,7 @@ KILLENUM Runtime::throwError( const ZString &mesg )
   ip = startLineIP; // rewind to capture whole line
   ZString line = readLine();
   zinfo() << "ZZTOOP ERROR:" << mesg << "-->" << line;
+  world->addScriptError();
   thing->setPaused(true);
   return COMMANDERROR;
 }
@@ -1342,6 +1426,7 @@ void Interpreter::setProgram( const unsigned char *stream, int length )
 
   program.resize( length );
   std::copy( stream, stream + length, program.begin() );
+  m_labelsIndexed = false;
 }
 
 ZString Interpreter::getObjectName() const
@@ -1349,39 +1434,93 @@ ZString Interpreter::getObjectName() const
   if ( length(program) < 2 ) return "";
   if ( program.at(0) != '@' ) return "";
 
-  signed short ip = 0;
+  signed short ip = 1;
   return getWholeLine( program, ip );
 }
 
+void Interpreter::indexLabels( SymbolTable &symbols )
+{
+  // labels only ever start a line, and zapping one just swaps its marker,
+  // so a single pass finds them all for good.
+  m_labels.clear();
+  const int size = length(program);
+  signed short ip = 0;
+  while ( ip < size )
+  {
+    const unsigned char marker = program.at( ip );
+
+    if ( marker == ':' || marker == '\'' ) {
+      Label label;
+      label.ip = ip;
+      ip++;
+      if ( ip >= size ) break;
+      const signed short start = ip;
+      ip = seekForward( program, ip, tokenDelimiters );
+      label.symbol = symbols.intern(
+          ZStringView( (const char *) &program[start], ip - start ) );
+      m_labels.push_back( label );
+    }
+    ip = seekForward( program, ip, wholeLineDelimiter );
+    if ( ip < size ) ip++;
+  }
+  m_labelsIndexed = true;
+}
+
+signed short Interpreter::findLabel( SymbolTable &symbols,
+                                     const ZStringView &label,
+                                     unsigned char marker )
+{
+  if ( !m_labelsIndexed ) {
+    indexLabels( symbols );
+  }
+
+  // every label got interned above, so an unknown name can't match
+  const int symbol = symbols.find( label );
+  if ( symbol == SymbolTable::None ) return -1;
+
+  for ( unsigned int i = 0; i < m_labels.size(); i++ ) {
+    if ( m_labels[i].symbol == symbol && program[ m_labels[i].ip ] == marker ) {
+      return m_labels[i].ip;
+    }
+  }
+  return -1;
+}
+
 void Interpreter::run( ScriptableThing *thing, int cycles )
 {
   ZZTOOP::Runtime runtime( thing, program );
   runtime.run( cycles );
 }
 
-void Interpreter::seekLabel( ScriptableThing *thing, const ZString &label )
+void Interpreter::seekLabel( ScriptableThing *thing, const ZStringView &label )
 {
-  signed short ip = thing->instructionPointer();
+  SymbolTable &symbols = thing->world()->symbols();
+
+  // restart is an implied label.
+  signed short ip = 0;
+  if ( symbols.find( label ) != SymbolTable::Restart ) {
+    ip = findLabel( symbols, label, ':' );
+  }
 
-  if ( seekToken( program, ":", label, ip, true ) ) {
+  if ( ip >= 0 ) {
     thing->setInstructionPointer(ip);
     thing->setPaused( false );
     zdebug() << "Found label --> " << label;
   }
 }
 
-void Interpreter::zapLabel( const ZString &label )
+void Interpreter::zapLabel( SymbolTable &symbols, const ZString &label )
 {
-  signed short ip = 0;
-  if ( seekToken( program, ":", label, ip, false ) ) {
+  const signed short ip = findLabel( symbols, label, ':' );
+  if ( ip >= 0 ) {
     program[ip] = '\'';
   }
 }
 
-void Interpreter::restoreLabel( const ZString &label )
+void Interpreter::restoreLabel( SymbolTable &symbols, const ZString &label )
 {
-  signed short ip = 0;
-  if ( seekToken( program, "\'", label, ip, false ) ) {
+  const signed short ip = findLabel( symbols, label, '\'' );
+  if ( ip >= 0 ) {
     program[ip] = ':';
   }
 }
@@ -11,6 +11,9 @@
 #include <vector>
 #include "zstring.h"
 
+class SymbolTable;
+class ZStringView;
+
 namespace ZZTThing {
   class ScriptableThing;
 };
@@ -21,10 +24,19 @@ namespace ZZTOOP {
 
 typedef std::vector<unsigned char> ProgramBank;
 
+/// where a label starts in a program, and which symbol it names
+struct Label
+{
+  int symbol;
+  /// the colon, or the apostrophe once it's zapped
+  signed short ip;
+};
+typedef std::vector<Label> LabelList;
+
 class Interpreter
 {
   public:
-    Interpreter() : m_board(0) { /* */ };
+    Interpreter() : m_board(0), m_labelsIndexed(false) { /* */ };
 
     void setBoard( GameBoard *board ) { m_board = board; };
     GameBoard *board() const { return m_board; };
@@ -33,14 +45,25 @@ class Interpreter
     ZString getObjectName() const;
 
     void run( ZZTThing::ScriptableThing *thing, int cycles );
-    void seekLabel( ZZTThing::ScriptableThing *thing, const ZString &label );
+    void seekLabel( ZZTThing::ScriptableThing *thing, const ZStringView &label );
+
+    void zapLabel( SymbolTable &symbols, const ZString &label );
+    void restoreLabel( SymbolTable &symbols, const ZString &label );
 
-    void zapLabel( const ZString &label );
-    void restoreLabel( const ZString &label );
+    /// program bank, including any zapped labels
+    const ProgramBank &programBank() const { return program; };
 
   private:
+    void indexLabels( SymbolTable &symbols );
+    /// first label named label behind marker, or -1
+    signed short findLabel( SymbolTable &symbols, const ZStringView &label,
+                            unsigned char marker );
+
     ProgramBank program;
     GameBoard *m_board;
+    /// built on the first seek, zap and restore keep it current
+    LabelList m_labels;
+    bool m_labelsIndexed;
 };
 
 // -------------------------------------
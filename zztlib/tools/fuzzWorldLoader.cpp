@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+// Feeds world files to WorldLoader and WorldIndex, along with randomly
+// broken copies of them. Neither may crash or read out of bounds, which
+// wants an ASan build to really tell, and a world the loader takes has
+// to index to the same number of boards.
+//
+// usage: fuzzWorldLoader [-m mutations] world.zzt ...
+//        fuzzWorldLoader --seed world.zzt dir
+//
+// --seed writes the starting corpus cut from a good world, that's how
+// tools/corpus was made from holding/acidtest.zzt.
+//
+// Built with -DFUZZ_WITH_LIBFUZZER and -fsanitize=fuzzer there's no main,
+// libFuzzer drives LLVMFuzzerTestOneInput over the corpus instead.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "gameBoard.h"
+#include "worldLoader.h"
+#include "worldIndex.h"
+#include "zztStructs.h"
+
+typedef std::vector<unsigned char> ByteArray;
+
+// the broken copies go through a file, that's all WorldLoader reads
+static const char *scratchFile = "fuzzWorldLoader.tmp";
+
+static bool readFile( const std::string &filename, ByteArray &data )
+{
+  std::ifstream file( filename.c_str(), std::ios::in|std::ios::binary );
+  if ( !file.is_open() ) return false;
+  data.assign( std::istreambuf_iterator<char>( file ),
+               std::istreambuf_iterator<char>() );
+  return true;
+}
+
+static bool writeFile( const std::string &filename, const ByteArray &data )
+{
+  std::ofstream file( filename.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+  if ( !file.is_open() ) return false;
+  if ( !data.empty() ) file.write( (const char*) &data[0], data.size() );
+  return file.good();
+}
+
+// ---------------------------------------------------------------------------
+
+/// loads the file both ways, false when they disagree
+static bool checkFile( const std::string &filename )
+{
+  WorldIndex index;
+  const bool indexed = index.scan( filename );
+
+  GameWorld *world = WorldLoader::loadWorld( filename );
+  if ( !world ) return true;
+
+  bool agree = indexed;
+  for ( int i = 0; agree && i < index.boardCount(); i++ ) {
+    agree = ( world->getBoard( i ) != 0 );
+  }
+  if ( agree ) {
+    agree = ( world->getBoard( index.boardCount() ) == 0 );
+  }
+  delete world;
+
+  if ( !agree ) {
+    std::printf( "fuzzWorldLoader: %s loads but indexes %s\n", filename.c_str(),
+                 indexed ? "to a different board count" : "as broken" );
+  }
+  return agree;
+}
+
+// ---------------------------------------------------------------------------
+
+/// small and repeatable, the same seed breaks a file the same way
+class Mutator
+{
+  public:
+    Mutator( unsigned int seed ) : state( seed ? seed : 1 ) { /* */ };
+
+    unsigned int next()
+    {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state;
+    };
+
+    void mutate( ByteArray &data )
+    {
+      const int count = 1 + next() % 4;
+      for ( int i = 0; i < count && !data.empty(); i++ ) {
+        const unsigned int pos = next() % data.size();
+        switch ( next() % 4 ) {
+          case 0:
+            data[pos] = next();
+            break;
+
+          case 1:
+            // sizes and counts are words, the edges are where it breaks
+            if ( pos + 1 < data.size() ) {
+              static const unsigned short edges[] = { 0xffff, 0x8000, 0x7fff, 0x0000 };
+              const unsigned short edge = edges[ next() % 4 ];
+              data[pos] = edge & 0xff;
+              data[pos+1] = edge >> 8;
+            }
+            break;
+
+          case 2:
+            data.resize( pos );
+            break;
+
+          default:
+            for ( unsigned int x = pos; x < data.size() && x < pos + 16; x++ ) {
+              data[x] = 0;
+            }
+            break;
+        }
+      }
+    };
+
+  private:
+    unsigned int state;
+};
+
+static bool fuzzFile( const std::string &filename, int mutations, int &checked )
+{
+  ByteArray original;
+  if ( !readFile( filename, original ) ) {
+    std::printf( "fuzzWorldLoader: can't read %s\n", filename.c_str() );
+    return false;
+  }
+
+  bool ok = checkFile( filename );
+  checked += 1;
+
+  for ( int i = 0; i < mutations; i++ ) {
+    ByteArray data( original );
+    Mutator( i + 1 ).mutate( data );
+    if ( !writeFile( scratchFile, data ) ) {
+      std::printf( "fuzzWorldLoader: can't write %s\n", scratchFile );
+      return false;
+    }
+    if ( !checkFile( scratchFile ) ) {
+      std::printf( "fuzzWorldLoader: mutation %d of %s\n", i + 1, filename.c_str() );
+      ok = false;
+    }
+    checked += 1;
+  }
+  return ok;
+}
+
+// ---------------------------------------------------------------------------
+
+static void putWord( ByteArray &data, int pos, unsigned short value )
+{
+  data[pos] = value & 0xff;
+  data[pos+1] = value >> 8;
+}
+
+/// first board of a world, size word included
+static ByteArray firstBoard( const ByteArray &world )
+{
+  const ZZTReader file( &world[0], world.size() );
+  const int size = BoardHeader::storedSize( file.window( WorldHeader::size, 2 ) );
+  if ( size < 0 || !file.fits( WorldHeader::size, size ) ) return ByteArray();
+  return ByteArray( world.begin() + WorldHeader::size,
+                    world.begin() + WorldHeader::size + size );
+}
+
+/// the world header with only the given board after it
+static ByteArray withBoard( const ByteArray &world, const ByteArray &board )
+{
+  ByteArray data( world.begin(), world.begin() + WorldHeader::size );
+  putWord( data, 2, 0 );
+  data.insert( data.end(), board.begin(), board.end() );
+  return data;
+}
+
+/// where the board's first thing starts, the player
+static int firstThing( const ByteArray &board )
+{
+  const ZZTReader data( &board[0], board.size() );
+  int pos = BoardHeader::size;
+  int count = 0;
+  while ( count < 1500 && data.fits( pos, 3 ) ) {
+    count += data.byte( pos );
+    pos += 3;
+  }
+  return pos + BoardInformation::size;
+}
+
+static bool writeSeeds( const std::string &filename, const std::string &dir )
+{
+  ByteArray world;
+  if ( !readFile( filename, world ) || (int) world.size() < WorldHeader::size ) {
+    std::printf( "fuzzWorldLoader: can't read %s\n", filename.c_str() );
+    return false;
+  }
+  const ByteArray board = firstBoard( world );
+  if ( board.empty() ) {
+    std::printf( "fuzzWorldLoader: %s has no first board\n", filename.c_str() );
+    return false;
+  }
+
+  bool ok = writeFile( dir + "/world.zzt", world );
+
+  ok &= writeFile( dir + "/header_only.zzt",
+                   ByteArray( world.begin(), world.begin() + WorldHeader::size ) );
+
+  ok &= writeFile( dir + "/one_board.zzt", withBoard( world, board ) );
+
+  ByteArray truncated( world.begin(), world.begin() + WorldHeader::size + board.size() + board.size() / 2 );
+  ok &= writeFile( dir + "/truncated.zzt", truncated );
+
+  ByteArray negative = withBoard( world, board );
+  putWord( negative, WorldHeader::size, 0xffff );
+  ok &= writeFile( dir + "/negative_size.zzt", negative );
+
+  ByteArray shortField( board.begin(), board.begin() + BoardHeader::size + 30 );
+  putWord( shortField, 0, shortField.size() - 2 );
+  ok &= writeFile( dir + "/short_field.zzt", withBoard( world, shortField ) );
+
+  ByteArray longProgram = withBoard( world, board );
+  const int thing = WorldHeader::size + firstThing( board );
+  if ( thing + ThingHeader::size <= (int) longProgram.size() ) {
+    putWord( longProgram, thing + 0x17, 0x7fff );
+    ok &= writeFile( dir + "/long_program.zzt", longProgram );
+  }
+
+  return ok;
+}
+
+// ---------------------------------------------------------------------------
+
+#ifdef FUZZ_WITH_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput( const unsigned char *data, size_t size )
+{
+  DebuggingStream::setGlobalLevel( DebuggingStream::ERRORS );
+  if ( !writeFile( scratchFile, ByteArray( data, data + size ) ) ) return 0;
+  if ( !checkFile( scratchFile ) ) abort();
+  return 0;
+}
+
+#else
+
+int main( int argc, char **argv )
+{
+  DebuggingStream::setGlobalLevel( DebuggingStream::ERRORS );
+
+  if ( argc == 4 && std::strcmp( argv[1], "--seed" ) == 0 ) {
+    return writeSeeds( argv[2], argv[3] ) ? 0 : 1;
+  }
+
+  int first = 1;
+  int mutations = 200;
+  if ( argc > 2 && std::strcmp( argv[1], "-m" ) == 0 ) {
+    mutations = atoi( argv[2] );
+    first = 3;
+  }
+
+  if ( first >= argc ) {
+    std::printf( "usage: %s [-m mutations] world.zzt ...\n"
+                 "       %s --seed world.zzt dir\n", argv[0], argv[0] );
+    return 2;
+  }
+
+  bool ok = true;
+  int checked = 0;
+  for ( int i = first; i < argc; i++ ) {
+    ok &= fuzzFile( argv[i], mutations, checked );
+  }
+  std::remove( scratchFile );
+
+  std::printf( "fuzzWorldLoader: %d files checked, %s\n", checked, ok ? "all fine" : "FAILED" );
+  return ok ? 0 : 1;
+}
+
+#endif // FUZZ_WITH_LIBFUZZER
+
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+// Counts heap allocations while an object runs a long ZZT-OOP program.
+// The tokenizer works on the program bytes in place, so once the flags
+// and the board are set up, running lines shouldn't allocate at all.
+//
+// usage: oopAllocBench world.zzt [lines] [runs]
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "gameBoard.h"
+#include "zztEntity.h"
+#include "scriptable.h"
+#include "scriptStats.h"
+#include "thingFactory.h"
+#include "zztoopInterp.h"
+#include "worldLoader.h"
+
+// ---------------------------------------------------------------------------
+
+static unsigned long allocations = 0;
+
+void *operator new( std::size_t size )
+{
+  allocations += 1;
+  void *ptr = std::malloc( size ? size : 1 );
+  if ( !ptr ) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[]( std::size_t size )
+{
+  return operator new( size );
+}
+
+void operator delete( void *ptr ) throw()
+{
+  std::free( ptr );
+}
+
+void operator delete[]( void *ptr ) throw()
+{
+  std::free( ptr );
+}
+
+// newer compilers call the sized forms, keep them on the same free
+void operator delete( void *ptr, std::size_t ) throw()
+{
+  std::free( ptr );
+}
+
+void operator delete[]( void *ptr, std::size_t ) throw()
+{
+  std::free( ptr );
+}
+
+// ---------------------------------------------------------------------------
+
+/// lines that only test and touch flags that already exist, the kind of
+/// busywork most objects spend their cycles on
+static const char *benchLines[] = {
+  "#if alpha #set beta\r",
+  "#if not gamma #clear gamma\r",
+  "#if beta #if alpha #char 2\r",
+  "#if not alpha #send nowhere\r",
+};
+
+static std::string benchProgram( int lines )
+{
+  const int kinds = sizeof( benchLines ) / sizeof( benchLines[0] );
+  std::string program = "@Bench\r";
+  for ( int i = 0; i < lines; i++ ) {
+    program += benchLines[ i % kinds ];
+  }
+  return program;
+}
+
+// ---------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  if ( argc < 2 ) {
+    std::printf( "usage: %s world.zzt [lines] [runs]\n", argv[0] );
+    return 2;
+  }
+
+  DebuggingStream::setGlobalLevel( DebuggingStream::WARNINGS );
+
+  const int lines = ( argc > 2 ) ? atoi( argv[2] ) : 600;
+  const int runs = ( argc > 3 ) ? atoi( argv[3] ) : 200;
+
+  GameWorld *world = WorldLoader::loadWorld( argv[1] );
+  if ( !world || !world->getBoard( 0 ) ) {
+    std::printf( "oopAllocBench: can't load %s\n", argv[1] );
+    return 2;
+  }
+
+  GameBoard *board = world->getBoard( 0 );
+  world->setCurrentBoard( board );
+  world->addGameFlag( ZString( "alpha" ) );
+  world->addGameFlag( ZString( "beta" ) );
+
+  ThingFactory factory;
+  factory.setWorld( world );
+  factory.setBoard( board );
+  ZZTThing::ScriptableThing *bench = dynamic_cast<ZZTThing::ScriptableThing*>(
+      factory.createEmptyThing( ZZTEntity::Object ) );
+  bench->setPos( 1, 1 );
+  board->addThing( bench );
+
+  const std::string program = benchProgram( lines );
+  ZZTOOP::Interpreter *interpreter = new ZZTOOP::Interpreter;
+  interpreter->setProgram( (const unsigned char *) program.data(), program.size() );
+  board->addInterpreter( interpreter );
+  bench->setInterpreter( interpreter );
+  bench->setInstructionPointer( 0 );
+  bench->setPaused( false );
+
+  // one pass to let anything lazy get itself set up
+  interpreter->run( bench, 1 );
+
+  const unsigned int startInstructions = bench->totalStats().instructions;
+  const unsigned long startAllocations = allocations;
+  for ( int i = 0; i < runs; i++ ) {
+    bench->setInstructionPointer( 0 );
+    interpreter->run( bench, 1 );
+  }
+  const unsigned long allocated = allocations - startAllocations;
+  const unsigned int instructions = bench->totalStats().instructions - startInstructions;
+
+  std::printf( "oopAllocBench: %u instructions, %lu allocations, %.4f per instruction\n",
+               instructions, allocated,
+               instructions ? double( allocated ) / instructions : 0.0 );
+
+  delete world;
+
+  if ( instructions == 0 ) {
+    std::printf( "oopAllocBench: the program never ran\n" );
+    return 2;
+  }
+  return ( allocated == 0 ) ? 0 : 1;
+}
+
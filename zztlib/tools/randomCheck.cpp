@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+// Checks Randomizer::randomRange over the small ranges the things use for
+// picking directions. Every value has to come up about as often as the
+// others, pairs of draws too, and the draws can't settle into a short
+// cycle the way the low bits of the generator do.
+//
+// usage: randomCheck [draws]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#include "randomizer.h"
+
+static const int maxPeriod = 64;
+
+/// each value within five standard deviations of its share, false when
+/// one isn't. A fair draw never gets that far, a broken one is way past it
+static bool checkSpread( const char *what, const std::vector<int> &counts, int draws )
+{
+  const double expected = double( draws ) / counts.size();
+  const double allowed = 5 * std::sqrt( expected );
+  bool ok = true;
+  for ( unsigned int i = 0; i < counts.size(); i++ ) {
+    if ( std::fabs( counts[i] - expected ) > allowed ) {
+      std::printf( "randomCheck: %s, %d came up %d times, wanted about %.0f\n",
+                   what, i, counts[i], expected );
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static bool checkRange( int top, int draws )
+{
+  Randomizer rnd;
+  rnd.seed( 1 );
+
+  std::vector<int> seq( draws );
+  std::vector<int> singles( top, 0 );
+  std::vector<int> pairs( top * top, 0 );
+  for ( int i = 0; i < draws; i++ ) {
+    seq[i] = rnd.randomRange( top );
+    if ( seq[i] < 0 || seq[i] >= top ) {
+      std::printf( "randomCheck: randomRange(%d) gave %d\n", top, seq[i] );
+      return false;
+    }
+    singles[ seq[i] ] += 1;
+    if ( i > 0 ) pairs[ seq[i-1] * top + seq[i] ] += 1;
+  }
+
+  char what[64];
+  std::sprintf( what, "randomRange(%d)", top );
+  bool ok = checkSpread( what, singles, draws );
+  std::sprintf( what, "randomRange(%d) pairs", top );
+  ok &= checkSpread( what, pairs, draws - 1 );
+
+  for ( int period = 1; period <= maxPeriod; period++ ) {
+    int same = 0;
+    for ( int i = period; i < draws; i++ ) {
+      if ( seq[i] == seq[i-period] ) same += 1;
+    }
+    if ( same == draws - period ) {
+      std::printf( "randomCheck: randomRange(%d) repeats every %d\n", top, period );
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+int main( int argc, char **argv )
+{
+  const int draws = ( argc > 1 ) ? atoi( argv[1] ) : 200000;
+  if ( draws <= maxPeriod ) {
+    std::printf( "usage: %s [draws]\n", argv[0] );
+    return 2;
+  }
+
+  bool ok = true;
+  static const int tops[] = { 2, 3, 4, 9, 10 };
+  for ( unsigned int i = 0; i < sizeof( tops ) / sizeof( tops[0] ); i++ ) {
+    ok &= checkRange( tops[i], draws );
+  }
+
+  // empty ranges give the bottom instead of dividing by zero
+  Randomizer rnd;
+  if ( rnd.randomRange( 0 ) != 0 || rnd.randomRange( -3 ) != 0 ||
+       rnd.randomBound( 5, 5 ) != 5 ) {
+    std::printf( "randomCheck: empty ranges don't come back empty\n" );
+    ok = false;
+  }
+
+  std::printf( "randomCheck: %d draws per range, %s\n", draws, ok ? "all fine" : "FAILED" );
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+// Runs the same board twice, once a cycle at a time with a paint between
+// each, the way the live game does, and once through turbo batches that
+// never paint. Both have to end up in the same state.
+//
+// usage: turboCheck world.zzt [board] [cycles] [turbo]
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include "debug.h"
+#include "zstring.h"
+#include "gameWorld.h"
+#include "gameBoard.h"
+#include "randomizer.h"
+#include "replay.h"
+#include "worldLoader.h"
+#include "abstractScrollModel.h"
+#include "scrollView.h"
+#include "nullMusicStream.h"
+#include "nullPainter.h"
+
+// ---------------------------------------------------------------------------
+
+/// closes a scroll the way the text view would, nobody's there to read it
+static void dismissScroll( ScrollView &view )
+{
+  if ( !view.model() ) return;
+  delete view.model();
+  view.setModel( 0 );
+}
+
+// ---------------------------------------------------------------------------
+
+class CheckedWorld
+{
+  public:
+    CheckedWorld( const ZString &filename, int board );
+    ~CheckedWorld();
+
+    bool ok() const { return world != 0; };
+
+  public:
+    GameWorld *world;
+    NullMusicStream musicStream;
+    NullPainter painter;
+    ScrollView scrollView;
+};
+
+CheckedWorld::CheckedWorld( const ZString &filename, int board )
+  : world( WorldLoader::loadWorld( filename ) )
+{
+  if ( !world ) return;
+  world->setMusicStream( &musicStream );
+  world->setScrollView( &scrollView );
+  world->setCurrentBoard( world->getBoard( board ) );
+  world->randomizer().seed( 1 );
+}
+
+CheckedWorld::~CheckedWorld()
+{
+  dismissScroll( scrollView );
+  if ( world ) {
+    world->setScrollView( 0 );
+    world->setMusicStream( 0 );
+  }
+  delete world;
+}
+
+// ---------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  if ( argc < 2 ) {
+    std::printf( "usage: %s world.zzt [board] [cycles] [turbo]\n", argv[0] );
+    return 2;
+  }
+
+  DebuggingStream::setGlobalLevel( DebuggingStream::WARNINGS );
+
+  const ZString filename = argv[1];
+  const int board = ( argc > 2 ) ? atoi( argv[2] ) : 0;
+  const int cycles = ( argc > 3 ) ? atoi( argv[3] ) : 200;
+  const int turbo = ( argc > 4 ) ? atoi( argv[4] ) : 20;
+
+  CheckedWorld normal( filename, board );
+  CheckedWorld batched( filename, board );
+  if ( !normal.ok() || !batched.ok() || !normal.world->currentBoard() ) {
+    std::printf( "turboCheck: can't load board %d of %s\n", board, filename.c_str() );
+    return 2;
+  }
+
+  for ( int i = 0; i < cycles; i++ ) {
+    normal.painter.begin();
+    normal.world->paint( &normal.painter );
+    normal.painter.end();
+    normal.world->exec();
+    dismissScroll( normal.scrollView );
+  }
+
+  // batches stop early for scrolls and board changes, so count cycles
+  // off the board instead of trusting the turbo factor.
+  int ran = 0;
+  while ( ran < cycles ) {
+    GameBoard *current = batched.world->currentBoard();
+    const unsigned int before = current->cycle();
+    batched.world->setTurbo( std::min( turbo, cycles - ran ) );
+    batched.world->update();
+    dismissScroll( batched.scrollView );
+
+    if ( batched.world->currentBoard() != current ) {
+      std::printf( "turboCheck: board changed at cycle %d, pick a board that stays put\n", ran );
+      return 2;
+    }
+    ran += current->cycle() - before;
+  }
+
+  const unsigned int normalHash = ReplayFile::hashWorld( normal.world );
+  const unsigned int batchedHash = ReplayFile::hashWorld( batched.world );
+  std::printf( "turboCheck: %d cycles, normal %08x, turbo %08x\n",
+               cycles, normalHash, batchedHash );
+
+  return ( normalHash == batchedHash ) ? 0 : 1;
+}
+
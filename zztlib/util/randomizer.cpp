@@ -4,17 +4,27 @@
 
 // Mimicking pascal's dumb randomizer.
 
-static unsigned int value = 1;
 static const unsigned int multiplier = 134775813;
 
-static void step()
+Randomizer::Randomizer()
+  : m_value( 1 )
 {
-  value = value * multiplier + 1;
+  /* */
+}
+
+void Randomizer::step()
+{
+  m_value = m_value * multiplier + 1;
 }
 
 void Randomizer::seed( unsigned int s )
 {
-  value = s;
+  m_value = s;
+}
+
+unsigned int Randomizer::state() const
+{
+  return m_value;
 }
 
 void Randomizer::timeSeed()
@@ -25,18 +35,20 @@ void Randomizer::timeSeed()
 unsigned int Randomizer::randomInt()
 {
   step();
-  return value;
+  return m_value;
 }
 
 int Randomizer::randomSInt()
 {
   step();
-  return value;
+  return m_value;
 }
 
 int Randomizer::randomRange( int top )
 {
-  return randomSInt() % top;
+  if ( top <= 0 ) return 0;
+  // scale by the high bits, the low bits of the generator just cycle
+  return (int)( ( (unsigned long long) randomInt() * top ) >> 32 );
 }
 
 int Randomizer::randomBound( int lower, int upper )
@@ -1,15 +1,26 @@
-
 #ifndef RANDOMIZER_H
 #define RANDOMIZER_H
 
-namespace Randomizer
+/// Each GameWorld owns one, so worlds running side by side don't
+/// disturb each other's sequences.
+class Randomizer
 {
-  void seed( unsigned int s );
-  void timeSeed();
-  unsigned int randomInt();
-  int randomSInt();
-  int randomRange( int top );
-  int randomBound( int lower, int upper );
+  public:
+    Randomizer();
+
+    void seed( unsigned int s );
+    unsigned int state() const;
+    void timeSeed();
+    unsigned int randomInt();
+    int randomSInt();
+    int randomRange( int top );
+    int randomBound( int lower, int upper );
+
+  private:
+    void step();
+
+    unsigned int m_value;
 };
 
 #endif
+
@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <vector>
+#include <string>
+
+#include "zstring.h"
+#include "snapshotStream.h"
+
+void SnapshotWriter::putByte( unsigned char value )
+{
+  m_buffer.push_back( value );
+}
+
+void SnapshotWriter::putWord( unsigned short value )
+{
+  m_buffer.push_back( value & 0xFF );
+  m_buffer.push_back( ( value >> 8 ) & 0xFF );
+}
+
+void SnapshotWriter::putDWord( unsigned int value )
+{
+  m_buffer.push_back( value & 0xFF );
+  m_buffer.push_back( ( value >> 8 ) & 0xFF );
+  m_buffer.push_back( ( value >> 16 ) & 0xFF );
+  m_buffer.push_back( ( value >> 24 ) & 0xFF );
+}
+
+void SnapshotWriter::putString( const ZStringView &value )
+{
+  putDWord( value.size() );
+  m_buffer.insert( m_buffer.end(), value.data(), value.data() + value.size() );
+}
+
+void SnapshotWriter::putBytes( const unsigned char *data, unsigned int length )
+{
+  m_buffer.insert( m_buffer.end(), data, data + length );
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned char SnapshotReader::getByte()
+{
+  if ( m_failed || m_pos + 1 > m_length ) {
+    m_failed = true;
+    return 0;
+  }
+  return m_data[m_pos++];
+}
+
+unsigned short SnapshotReader::getWord()
+{
+  const unsigned char *p = getBytes( 2 );
+  if (!p) return 0;
+  return p[0] | ( p[1] << 8 );
+}
+
+unsigned int SnapshotReader::getDWord()
+{
+  const unsigned char *p = getBytes( 4 );
+  if (!p) return 0;
+  return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int) p[3] << 24 );
+}
+
+ZString SnapshotReader::getString()
+{
+  const unsigned int length = getDWord();
+  const unsigned char *p = getBytes( length );
+  if (!p) return ZString();
+  return ZString( (const char *) p, length );
+}
+
+ZStringView SnapshotReader::getStringView()
+{
+  const unsigned int length = getDWord();
+  const unsigned char *p = getBytes( length );
+  if (!p) return ZStringView();
+  return ZStringView( (const char *) p, length );
+}
+
+const unsigned char *SnapshotReader::getBytes( unsigned int length )
+{
+  if ( m_failed || length > m_length - m_pos ) {
+    m_failed = true;
+    return 0;
+  }
+  const unsigned char *p = m_data + m_pos;
+  m_pos += length;
+  return p;
+}
+
+// ---------------------------------------------------------------------------
+
+SnapshotBlob::SnapshotBlob( const SnapshotBlob &other )
+  : m_data( other.m_data )
+{
+  if (m_data) m_data->refs += 1;
+}
+
+SnapshotBlob::SnapshotBlob( SnapshotBytes &bytes )
+  : m_data( new Shared )
+{
+  // steal the bytes instead of copying them
+  m_data->refs = 1;
+  m_data->bytes.swap( bytes );
+}
+
+SnapshotBlob::~SnapshotBlob()
+{
+  release();
+}
+
+SnapshotBlob &SnapshotBlob::operator=( const SnapshotBlob &other )
+{
+  if ( other.m_data ) other.m_data->refs += 1;
+  release();
+  m_data = other.m_data;
+  return *this;
+}
+
+void SnapshotBlob::release()
+{
+  if ( m_data && --m_data->refs == 0 ) {
+    delete m_data;
+  }
+  m_data = 0;
+}
+
+const unsigned char *SnapshotBlob::data() const
+{
+  if ( !m_data || m_data->bytes.empty() ) return 0;
+  return &m_data->bytes[0];
+}
+
+unsigned int SnapshotBlob::size() const
+{
+  return m_data ? m_data->bytes.size() : 0;
+}
+
@@ -0,0 +1,97 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __SNAPSHOT_STREAM_H__
+#define __SNAPSHOT_STREAM_H__
+
+#include <vector>
+#include "zstring.h"
+
+typedef std::vector<unsigned char> SnapshotBytes;
+
+/// appends little-endian values to a byte buffer
+class SnapshotWriter
+{
+  public:
+    SnapshotWriter( SnapshotBytes &buffer ) : m_buffer(buffer) { /* */ };
+
+    void putByte( unsigned char value );
+    void putBool( bool value ) { putByte( value ? 1 : 0 ); };
+    void putWord( unsigned short value );
+    void putDWord( unsigned int value );
+    void putInt( int value ) { putDWord( (unsigned int) value ); };
+    void putString( const ZStringView &value );
+    void putBytes( const unsigned char *data, unsigned int length );
+
+    /// bytes written so far
+    unsigned int size() const { return m_buffer.size(); };
+
+  private:
+    SnapshotBytes &m_buffer;
+};
+
+/// reads what SnapshotWriter wrote. Reading past the end returns zeros
+/// and leaves the reader failed, so callers can check once at the end.
+class SnapshotReader
+{
+  public:
+    SnapshotReader( const unsigned char *data, unsigned int length )
+      : m_data(data), m_length(length), m_pos(0), m_failed(false) { /* */ };
+
+    unsigned char getByte();
+    bool getBool() { return getByte() != 0; };
+    unsigned short getWord();
+    unsigned int getDWord();
+    int getInt() { return (int) getDWord(); };
+    ZString getString();
+    /// same as getString, but left where it is inside the buffer
+    ZStringView getStringView();
+    /// pointer to length bytes inside the buffer, or 0 if there aren't enough
+    const unsigned char *getBytes( unsigned int length );
+
+    /// marks the stream as bad, for callers that find nonsense values
+    void fail() { m_failed = true; };
+    bool ok() const { return !m_failed; };
+    bool atEnd() const { return m_pos >= m_length; };
+
+  private:
+    const unsigned char *m_data;
+    unsigned int m_length;
+    unsigned int m_pos;
+    bool m_failed;
+};
+
+/// reference counted, immutable byte buffer. Copies share the same bytes,
+/// so snapshots can hold onto unchanged parts of each other for free.
+class SnapshotBlob
+{
+  public:
+    SnapshotBlob() : m_data(0) { /* */ };
+    SnapshotBlob( const SnapshotBlob &other );
+    explicit SnapshotBlob( SnapshotBytes &bytes );
+    ~SnapshotBlob();
+
+    SnapshotBlob &operator=( const SnapshotBlob &other );
+
+    bool isNull() const { return !m_data; };
+    const unsigned char *data() const;
+    unsigned int size() const;
+
+    /// two blobs sharing the same bytes
+    bool sameAs( const SnapshotBlob &other ) const { return m_data == other.m_data; };
+
+  private:
+    struct Shared {
+      int refs;
+      SnapshotBytes bytes;
+    };
+    void release();
+
+    Shared *m_data;
+};
+
+#endif /* __SNAPSHOT_STREAM_H__ */
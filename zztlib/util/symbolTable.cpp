@@ -0,0 +1,82 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <vector>
+#include <string>
+
+#include "zstring.h"
+#include "zstringView.h"
+#include "symbolTable.h"
+
+SymbolTable::SymbolTable()
+  : m_slots( 64, None )
+{
+  intern( "ALL" );
+  intern( "OTHERS" );
+  intern( "RESTART" );
+}
+
+int SymbolTable::slotOf( const ZStringView &name, unsigned int nameHash ) const
+{
+  // linear probing, the table is never more than half full
+  const unsigned int mask = m_slots.size() - 1;
+  unsigned int slot = nameHash & mask;
+  while ( m_slots[slot] != None ) {
+    const int symbol = m_slots[slot];
+    if ( m_hashes[symbol] == nameHash &&
+         name.equalsNoCase( ZStringView( m_names[symbol] ) ) ) {
+      break;
+    }
+    slot = ( slot + 1 ) & mask;
+  }
+  return slot;
+}
+
+void SymbolTable::grow()
+{
+  std::vector<int> slots( m_slots.size() * 2, None );
+  const unsigned int mask = slots.size() - 1;
+  for ( unsigned int symbol = 0; symbol < m_names.size(); symbol++ ) {
+    unsigned int slot = m_hashes[symbol] & mask;
+    while ( slots[slot] != None ) {
+      slot = ( slot + 1 ) & mask;
+    }
+    slots[slot] = symbol;
+  }
+  m_slots.swap( slots );
+}
+
+int SymbolTable::intern( const ZStringView &name )
+{
+  const unsigned int nameHash = name.hashNoCase();
+  const int slot = slotOf( name, nameHash );
+  if ( m_slots[slot] != None ) {
+    return m_slots[slot];
+  }
+
+  const int symbol = m_names.size();
+  m_names.push_back( ZString( name.str() ).upper() );
+  m_hashes.push_back( nameHash );
+  m_slots[slot] = symbol;
+
+  if ( m_names.size() * 2 > m_slots.size() ) {
+    grow();
+  }
+  return symbol;
+}
+
+int SymbolTable::find( const ZStringView &name ) const
+{
+  return m_slots[ slotOf( name, name.hashNoCase() ) ];
+}
+
+const ZString &SymbolTable::name( int symbol ) const
+{
+  static const ZString noName;
+  if ( symbol < 0 || symbol >= (int) m_names.size() ) return noName;
+  return m_names[symbol];
+}
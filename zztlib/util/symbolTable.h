@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __SYMBOL_TABLE_H__
+#define __SYMBOL_TABLE_H__
+
+#include <vector>
+#include "zstring.h"
+#include "zstringView.h"
+
+/// Object names, flags and labels, each given a small number the first
+/// time it's seen. Case is folded, so two names that zzt-oop would call
+/// the same get the same symbol, and comparing them is comparing ints.
+/// Each GameWorld owns one.
+class SymbolTable
+{
+  public:
+    /// the names zzt-oop gives a meaning of its own always come first
+    enum Predefined {
+      None = -1,
+      All = 0,
+      Others,
+      Restart
+    };
+
+    SymbolTable();
+
+    /// the symbol for name, adding it if it's new
+    int intern( const ZStringView &name );
+    /// the symbol for name, None if it was never interned. Never allocates.
+    int find( const ZStringView &name ) const;
+
+    /// upper cased name of a symbol
+    const ZString &name( int symbol ) const;
+    /// symbols handed out so far
+    int size() const { return m_names.size(); };
+
+  private:
+    int slotOf( const ZStringView &name, unsigned int nameHash ) const;
+    void grow();
+
+    std::vector<ZString> m_names;
+    std::vector<unsigned int> m_hashes;
+    /// open addressed, a power of two long, None for empty slots
+    std::vector<int> m_slots;
+};
+
+#endif /* __SYMBOL_TABLE_H__ */
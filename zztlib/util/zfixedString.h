@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __ZZT_FIXED_STRING_H__
+#define __ZZT_FIXED_STRING_H__
+
+#include <cstring>
+#include <ostream>
+
+#include "zstring.h"
+#include "zstringView.h"
+
+/// String kept inside the object, for zzt's fixed size fields. It never
+/// allocates, anything past Capacity gets cut off like zzt's own strings.
+template <int Capacity>
+class ZFixedString
+{
+  public:
+    ZFixedString() : m_size(0) { m_data[0] = 0; };
+    ZFixedString( const ZStringView &str ) { assign( str ); };
+
+    ZFixedString &operator=( const ZStringView &str )
+    {
+      assign( str );
+      return *this;
+    };
+
+    void assign( const ZStringView &str )
+    {
+      m_size = str.size() < (size_t) Capacity ? str.size() : Capacity;
+      if ( m_size ) memcpy( m_data, str.data(), m_size );
+      m_data[m_size] = 0;
+    };
+
+    void clear() { assign( ZStringView() ); };
+
+    static int capacity() { return Capacity; };
+    int size() const { return m_size; };
+    bool empty() const { return m_size == 0; };
+    const char *data() const { return m_data; };
+    const char *c_str() const { return m_data; };
+
+    ZStringView view() const { return ZStringView( m_data, m_size ); };
+    operator ZStringView() const { return view(); };
+    /// owning copy, for the places that still want a ZString
+    ZString str() const { return ZString( m_data, m_size ); };
+
+    bool equalsNoCase( const ZStringView &other ) const
+    {
+      return view().equalsNoCase( other );
+    };
+
+  private:
+    char m_data[ Capacity + 1 ];
+    int m_size;
+};
+
+template <int Capacity>
+inline std::ostream &operator<<( std::ostream &out, const ZFixedString<Capacity> &str )
+{
+  return out << str.view();
+}
+
+#endif // __ZZT_FIXED_STRING_H__
+
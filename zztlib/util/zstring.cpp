@@ -31,6 +31,26 @@ ZString ZString::lower() const
   return next;
 }
 
+bool ZString::equalsNoCase( const ZStringView &other ) const
+{
+  return ZStringView( *this ).equalsNoCase( other );
+}
+
+int ZString::compareNoCase( const ZStringView &other ) const
+{
+  return ZStringView( *this ).compareNoCase( other );
+}
+
+unsigned int ZString::hashNoCase() const
+{
+  return ZStringView( *this ).hashNoCase();
+}
+
+ZString::size_type ZString::findNoCase( const ZStringView &needle, size_type pos ) const
+{
+  return ZStringView( *this ).findNoCase( needle, pos );
+}
+
 bool ZString::isNumber() const
 {
   for ( const_iterator iter = begin(); iter < end(); iter++ ) {
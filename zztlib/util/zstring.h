@@ -4,6 +4,8 @@
 #include <string>
 #include <list>
 
+#include "zstringView.h"
+
 class ZString : public std::string
 {
   public:
@@ -20,6 +22,12 @@ class ZString : public std::string
     void toLower();
     ZString lower() const;
 
+    /// case blind compare, hash and search, without an upper cased copy
+    bool equalsNoCase( const ZStringView &other ) const;
+    int compareNoCase( const ZStringView &other ) const;
+    unsigned int hashNoCase() const;
+    size_type findNoCase( const ZStringView &needle, size_type pos = 0 ) const;
+
     bool isNumber() const;
     unsigned int uint( bool *error = 0, int base = 10 ) const;
     int sint( bool *error = 0, int base = 10 ) const;
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef __ZZT_STRING_VIEW_H__
+#define __ZZT_STRING_VIEW_H__
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <ostream>
+
+/// Non-owning window onto someone else's characters. Never allocates,
+/// so the owner has to outlive it.
+class ZStringView
+{
+  public:
+    ZStringView() : m_data(0), m_size(0) { /* */ };
+    ZStringView( const char *data, size_t size ) : m_data(data), m_size(size) { /* */ };
+    ZStringView( const char *s ) : m_data(s), m_size(strlen(s)) { /* */ };
+    ZStringView( const std::string &s ) : m_data(s.data()), m_size(s.size()) { /* */ };
+
+    static const size_t npos = (size_t) -1;
+
+    const char *data() const { return m_data; };
+    size_t size() const { return m_size; };
+    bool empty() const { return m_size == 0; };
+    char operator[]( size_t i ) const { return m_data[i]; };
+
+    /// narrower view of the same characters
+    ZStringView sub( size_t pos, size_t len ) const
+    {
+      if ( pos > m_size ) pos = m_size;
+      if ( len > m_size - pos ) len = m_size - pos;
+      return ZStringView( m_data + pos, len );
+    };
+
+    /// first position from pos on holding one of the set, or npos.
+    /// like std::string, the set's terminator isn't part of it.
+    size_t findFirstOf( const char *set, size_t pos = 0 ) const
+    {
+      for ( size_t i = pos; i < m_size; i++ ) {
+        if ( m_data[i] && strchr( set, m_data[i] ) ) return i;
+      }
+      return npos;
+    };
+
+    /// first position from pos on holding none of the set, or npos
+    size_t findFirstNotOf( const char *set, size_t pos = 0 ) const
+    {
+      for ( size_t i = pos; i < m_size; i++ ) {
+        if ( !m_data[i] || !strchr( set, m_data[i] ) ) return i;
+      }
+      return npos;
+    };
+
+    /// true if every character is a digit, like ZString::isNumber
+    bool isNumber() const
+    {
+      for ( size_t i = 0; i < m_size; i++ ) {
+        if ( m_data[i] < '0' || m_data[i] > '9' ) return false;
+      }
+      return true;
+    };
+
+    /// leading decimal number, like ZString::sint but without the copy
+    int sint() const
+    {
+      size_t i = 0;
+      bool negative = false;
+      if ( i < m_size && ( m_data[i] == '-' || m_data[i] == '+' ) ) {
+        negative = ( m_data[i] == '-' );
+        i++;
+      }
+      long value = 0;
+      for ( ; i < m_size && m_data[i] >= '0' && m_data[i] <= '9'; i++ ) {
+        if ( value < 0x7FFFFFFF ) value = value * 10 + ( m_data[i] - '0' );
+      }
+      if ( value > 0x7FFFFFFF ) value = 0x7FFFFFFF;
+      return negative ? -value : value;
+    };
+
+    /// owning copy, for when it has to outlive the view
+    std::string str() const { return m_size ? std::string( m_data, m_size ) : std::string(); };
+
+    /// ascii only, which is all zzt ever had
+    static char upper( char c ) { return ( c >= 'a' && c <= 'z' ) ? c - 'a' + 'A' : c; };
+
+    /// compares without caring about ascii case
+    bool equalsNoCase( const ZStringView &other ) const
+    {
+      if ( m_size != other.m_size ) return false;
+      for ( size_t i = 0; i < m_size; i++ ) {
+        if ( upper( m_data[i] ) != upper( other.m_data[i] ) ) return false;
+      }
+      return true;
+    };
+
+    /// ordering without caring about ascii case, negative, zero or positive
+    int compareNoCase( const ZStringView &other ) const
+    {
+      const size_t len = m_size < other.m_size ? m_size : other.m_size;
+      for ( size_t i = 0; i < len; i++ ) {
+        const unsigned char a = upper( m_data[i] );
+        const unsigned char b = upper( other.m_data[i] );
+        if ( a != b ) return a < b ? -1 : 1;
+      }
+      return m_size < other.m_size ? -1 : m_size > other.m_size ? 1 : 0;
+    };
+
+    /// FNV-1a over the upper cased characters, so "Foo" and "FOO" collide
+    unsigned int hashNoCase() const
+    {
+      unsigned int hash = 2166136261u;
+      for ( size_t i = 0; i < m_size; i++ ) {
+        hash ^= (unsigned char) upper( m_data[i] );
+        hash *= 16777619u;
+      }
+      return hash;
+    };
+
+    /// first position from pos on where needle starts, ignoring case, or npos
+    size_t findNoCase( const ZStringView &needle, size_t pos = 0 ) const
+    {
+      if ( pos > m_size || needle.m_size > m_size - pos ) return npos;
+      const size_t last = m_size - needle.m_size;
+      for ( size_t i = pos; i <= last; i++ ) {
+        if ( sub( i, needle.m_size ).equalsNoCase( needle ) ) return i;
+      }
+      return npos;
+    };
+
+  private:
+    const char *m_data;
+    size_t m_size;
+};
+
+inline std::ostream &operator<<( std::ostream &out, const ZStringView &view )
+{
+  return out.write( view.data(), view.size() );
+}
+
+#endif // __ZZT_STRING_VIEW_H__
+
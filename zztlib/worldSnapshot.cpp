@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#include <vector>
+
+#include "debug.h"
+#include "zstring.h"
+#include "snapshotStream.h"
+#include "worldSnapshot.h"
+
+static const char snapshotMagic[] = "FZSN";
+static const int snapshotVersion = 2;
+
+void WorldSnapshot::clear()
+{
+  worldState = SnapshotBlob();
+  boards.clear();
+}
+
+unsigned int WorldSnapshot::size() const
+{
+  unsigned int total = worldState.size();
+  for ( unsigned int i = 0; i < boards.size(); i++ ) {
+    total += boards[i].size();
+  }
+  return total;
+}
+
+static void putBlob( SnapshotWriter &out, const SnapshotBlob &blob )
+{
+  out.putDWord( blob.size() );
+  out.putBytes( blob.data(), blob.size() );
+}
+
+static SnapshotBlob getBlob( SnapshotReader &in )
+{
+  const unsigned int length = in.getDWord();
+  const unsigned char *data = in.getBytes( length );
+  if ( !data || length == 0 ) {
+    return SnapshotBlob();
+  }
+
+  SnapshotBytes bytes( data, data + length );
+  return SnapshotBlob( bytes );
+}
+
+void WorldSnapshot::serialize( SnapshotBytes &out ) const
+{
+  SnapshotWriter writer( out );
+  writer.putBytes( (const unsigned char *) snapshotMagic, 4 );
+  writer.putWord( snapshotVersion );
+
+  putBlob( writer, worldState );
+  writer.putWord( boards.size() );
+  for ( unsigned int i = 0; i < boards.size(); i++ ) {
+    putBlob( writer, boards[i] );
+  }
+}
+
+bool WorldSnapshot::deserialize( const unsigned char *data, unsigned int length )
+{
+  clear();
+
+  SnapshotReader reader( data, length );
+  const unsigned char *magic = reader.getBytes( 4 );
+  if ( !magic || ZString( (const char *) magic, 4 ) != snapshotMagic ) {
+    zwarn() << "WorldSnapshot::deserialize: not a snapshot";
+    return false;
+  }
+
+  const int version = reader.getWord();
+  if ( version != snapshotVersion ) {
+    zwarn() << "WorldSnapshot::deserialize: unknown version" << version;
+    return false;
+  }
+
+  worldState = getBlob( reader );
+  const int boardCount = reader.getWord();
+  for ( int i = 0; i < boardCount && reader.ok(); i++ ) {
+    boards.push_back( getBlob( reader ) );
+  }
+
+  if ( !reader.ok() || worldState.isNull() ) {
+    zwarn() << "WorldSnapshot::deserialize: truncated";
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @author  Inmatarian <inmatarian@gmail.com>
+ * @section LICENSE
+ * Insert copyright and license information here.
+ */
+
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+#include <vector>
+#include "snapshotStream.h"
+
+/// The complete state of a running GameWorld. Boards are held as shared
+/// blobs, so snapshots taken in a row only pay for the boards that changed.
+class WorldSnapshot
+{
+  public:
+    /// drops everything held
+    void clear();
+    /// true if nothing has been saved into it
+    bool isNull() const { return worldState.isNull(); };
+
+    /// bytes held by this snapshot, shared boards included
+    unsigned int size() const;
+
+    /// flattens the snapshot for writing to disk
+    void serialize( SnapshotBytes &out ) const;
+    /// reads back what serialize wrote. false on bad data.
+    bool deserialize( const unsigned char *data, unsigned int length );
+
+  public:
+    /// counters, flags and the like
+    SnapshotBlob worldState;
+    /// one per board index, null for missing boards
+    std::vector<SnapshotBlob> boards;
+};
+
+#endif // WORLD_SNAPSHOT_H
+
@@ -81,6 +81,14 @@ ZZTEntity ZZTEntity::createEntity( unsigned char id, unsigned char color )
   return ZZTEntity();
 }
 
+unsigned char ZZTEntity::fileColor() const
+{
+  if ( m_id >= BlueText && m_id <= GreyBlinkingText ) {
+    return m_tile;
+  }
+  return m_color;
+}
+
 static ZZTEntity g_sharedEdgeOfBoardEntity =
     ZZTEntity::createEntity( ZZTEntity::EdgeOfBoard, 0x11 );
 
@@ -40,6 +40,8 @@ class ZZTEntity
     unsigned char color() const { return m_color; };
     /// sets the entity's encoded color, from the 256 back and fore colors.
     void setColor( unsigned char color ) { m_color = color; };
+    /// the color byte as a zzt file has it, text keeps its character there
+    unsigned char fileColor() const;
 
     /// accessor
     ZZTThing::AbstractThing *thing() const { return m_thing; };